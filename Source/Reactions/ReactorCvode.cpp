@@ -502,6 +502,130 @@ ReactorCvode::initCvode(
   return (0);
 }
 
+#ifdef SOOT_MODEL
+int
+ReactorCvode::initCvodeSoot(
+  N_Vector& a_y,
+  SUNMatrix& a_A,
+  CVODESootUserData* a_udata,
+  SUNNonlinearSolver& a_NLS,
+  SUNLinearSolver& a_LS,
+  void* a_cvode_mem,
+  const amrex::Real& a_time,
+  const SootODEData& a_soot_data)
+{
+  // Species, temperature and soot variables of a single cell
+  const int neq = NUM_SPECIES + 1 + NUM_SOOT_ODE;
+  a_y = N_VNew_Serial(neq, *amrex::sundials::The_Sundials_Context());
+  if (utils::check_flag(static_cast<void*>(a_y), "N_VNew_Serial", 0) != 0) {
+    return (1);
+  }
+
+  int flag = CVodeSetUserData(a_cvode_mem, a_udata);
+  if (utils::check_flag(&flag, "CVodeSetUserData", 1) != 0) {
+    return (1);
+  }
+
+  flag = CVodeInit(a_cvode_mem, cF_RHS_soot, a_time, a_y);
+  if (utils::check_flag(&flag, "CVodeInit", 1) != 0) {
+    return (1);
+  }
+
+  // The analytical Jacobians and preconditioners do not include the soot, the
+  // direct solves use a finite difference Jacobian and GMRES is not
+  // preconditioned
+  if (m_solve_type == cvode::fixedPoint) {
+    a_NLS = SUNNonlinSol_FixedPoint(
+      a_y, max_fp_accel, *amrex::sundials::The_Sundials_Context());
+    if (static_cast<bool>(utils::check_flag(
+          static_cast<void*>(a_NLS), "SUNNonlinSol_FixedPoint", 0))) {
+      return (1);
+    }
+    flag = CVodeSetNonlinearSolver(a_cvode_mem, a_NLS);
+    if (static_cast<bool>(
+          utils::check_flag(&flag, "CVodeSetNonlinearSolver", 1))) {
+      return (1);
+    }
+  } else if (
+    m_solve_type == cvode::denseFDDirect ||
+    m_solve_type == cvode::denseDirect) {
+    a_A = SUNDenseMatrix(neq, neq, *amrex::sundials::The_Sundials_Context());
+    if (utils::check_flag(static_cast<void*>(a_A), "SUNDenseMatrix", 0) != 0) {
+      return (1);
+    }
+    a_LS = SUNLinSol_Dense(a_y, a_A, *amrex::sundials::The_Sundials_Context());
+    if (
+      utils::check_flag(static_cast<void*>(a_LS), "SUNLinSol_Dense", 0) != 0) {
+      return (1);
+    }
+    flag = CVodeSetLinearSolver(a_cvode_mem, a_LS, a_A);
+    if (utils::check_flag(&flag, "CVodeSetLinearSolver", 1) != 0) {
+      return (1);
+    }
+  } else if (
+    m_solve_type == cvode::GMRES || m_solve_type == cvode::precGMRES) {
+    a_LS = SUNLinSol_SPGMR(
+      a_y, SUN_PREC_NONE, 0, *amrex::sundials::The_Sundials_Context());
+    if (
+      utils::check_flag(static_cast<void*>(a_LS), "SUNLinSol_SPGMR", 0) != 0) {
+      return (1);
+    }
+    flag = CVodeSetLinearSolver(a_cvode_mem, a_LS, nullptr);
+    if (utils::check_flag(&flag, "CVodeSetLinearSolver", 1) != 0) {
+      return (1);
+    }
+    flag = CVodeSetJacTimes(a_cvode_mem, nullptr, nullptr);
+    if (utils::check_flag(&flag, "CVodeSetJacTimes", 1) != 0) {
+      return (1);
+    }
+  } else {
+    amrex::Abort(
+      "Soot integration with ReactorCvode requires cvode.solve_type "
+      "fixed_point, dense_direct, denseAJ_direct, GMRES or precGMRES");
+  }
+
+  // CVODE runtime options
+  flag = CVodeSetMaxNonlinIters(a_cvode_mem, max_nls_iters); // Max newton iter.
+  if (utils::check_flag(&flag, "CVodeSetMaxNonlinIters", 1) != 0) {
+    return (1);
+  }
+  flag = CVodeSetMaxErrTestFails(a_cvode_mem, 100); // Max Err.test failure
+  if (utils::check_flag(&flag, "CVodeSetMaxErrTestFails", 1) != 0) {
+    return (1);
+  }
+  flag = CVodeSetMaxNumSteps(a_cvode_mem, 10000); // Max substeps
+  if (utils::check_flag(&flag, "CVodeSetMaxNumSteps", 1) != 0) {
+    return (1);
+  }
+  flag = CVodeSetMaxOrd(a_cvode_mem, m_cvode_maxorder); // Max order
+  if (utils::check_flag(&flag, "CVodeSetMaxOrd", 1) != 0) {
+    return (1);
+  }
+  if (a_LS != nullptr) {
+    flag = CVodeSetJacEvalFrequency(a_cvode_mem, 100); // Max Jac age
+    if (utils::check_flag(&flag, "CVodeSetJacEvalFrequency", 1) != 0) {
+      return (1);
+    }
+  }
+
+  // Gas tolerances as in react(), soot tolerances from the soot model
+  N_Vector atol = N_VNew_Serial(neq, *amrex::sundials::The_Sundials_Context());
+  amrex::Real* ratol = N_VGetArrayPointer(atol);
+  for (int k = 0; k < NUM_SPECIES + 1; k++) {
+    ratol[k] = (m_typ_vals[0] > 0.0) ? m_typ_vals[k] * absTol : absTol;
+  }
+  for (int k = 0; k < NUM_SOOT_ODE; k++) {
+    ratol[NUM_SPECIES + 1 + k] = a_soot_data.abs_tol[k];
+  }
+  flag = CVodeSVtolerances(a_cvode_mem, relTol, atol);
+  N_VDestroy(atol);
+  if (utils::check_flag(&flag, "CVodeSVtolerances", 1) != 0) {
+    return (1);
+  }
+  return (0);
+}
+#endif
+
 #endif // End check GPU for initCvode method
 
 void
@@ -1488,6 +1612,152 @@ ReactorCvode::react(
   return static_cast<int>(nfe);
 }
 
+#ifdef SOOT_MODEL
+int
+ReactorCvode::react_soot(
+  const amrex::Box& box,
+  amrex::Array4<amrex::Real> const& rY_in,
+  amrex::Array4<amrex::Real> const& rYsrc_in,
+  amrex::Array4<amrex::Real> const& T_in,
+  amrex::Array4<amrex::Real> const& rEner_in,
+  amrex::Array4<amrex::Real> const& rEner_src_in,
+  amrex::Array4<amrex::Real> const& FC_in,
+  amrex::Array4<int> const& mask,
+  amrex::Array4<amrex::Real> const& soot_in,
+  amrex::Array4<const amrex::Real> const& soot_src_in,
+  amrex::Array4<const amrex::Real> const& mu_in,
+  const SootODEData& soot_data,
+  amrex::Real& dt_react,
+  amrex::Real& time
+#ifdef AMREX_USE_GPU
+  ,
+  amrex::gpuStream_t /*stream*/
+#endif
+)
+{
+  BL_PROFILE("Pele::ReactorCvode::react_soot()");
+
+#ifdef AMREX_USE_GPU
+  amrex::ignore_unused(
+    box, rY_in, rYsrc_in, T_in, rEner_in, rEner_src_in, FC_in, mask, soot_in,
+    soot_src_in, mu_in, soot_data, dt_react, time);
+  amrex::Abort(
+    "Soot integration with ReactorCvode is only available on CPU, use "
+    "ReactorRK64 on GPU");
+  return 0;
+#else
+  // Same single cell integration as the CPU region of react(), with the soot
+  // variables appended to the state of the cell
+  amrex::Real time_start = time;
+  amrex::Real time_final = time + dt_react;
+  amrex::Real CvodeActual_time_final = 0.0;
+
+  SUNMatrix A = nullptr;
+  auto* udata = new CVODESootUserData{};
+  SUNNonlinearSolver NLS = nullptr;
+  SUNLinearSolver LS = nullptr;
+  N_Vector y = nullptr;
+  void* cvode_mem =
+    CVodeCreate(CV_BDF, *amrex::sundials::The_Sundials_Context());
+
+  udata->time_init = time_start;
+  udata->reactor_type = m_reactor_type;
+  udata->soot_data = soot_data;
+  const int init_flag =
+    initCvodeSoot(y, A, udata, NLS, LS, cvode_mem, time_start, soot_data);
+  if (init_flag != 0) {
+    amrex::Abort("ReactorCvode::react_soot(): CVODE initialization failed");
+  }
+
+  const int icell = 0;
+  const int ncells = 1;
+  const int isoot = NUM_SPECIES + 1;
+  const int ienrg = isoot + NUM_SOOT_MOMENTS + 1;
+  const SootData* sd = soot_data.sd;
+  const auto captured_reactor_type = m_reactor_type;
+  const auto captured_clean_init_massfrac = m_clean_init_massfrac;
+  const int captured_verbose = verbose;
+  ParallelFor(
+    box, [=, &CvodeActual_time_final] AMREX_GPU_DEVICE(
+           int i, int j, int k) noexcept {
+      if (mask(i, j, k) != -1) {
+
+        amrex::Real* yvec_d = N_VGetArrayPointer(y);
+        utils::box_flatten<Ordering>(
+          icell, i, j, k, ncells, captured_reactor_type,
+          captured_clean_init_massfrac, rY_in, rYsrc_in, T_in, rEner_in,
+          rEner_src_in, yvec_d, udata->rYsrc_ext, &udata->rhoe_init,
+          &udata->rhoesrc_ext);
+        // Moments and their forcing in mol of C
+        for (int n = 0; n < NUM_SOOT_MOMENTS + 1; n++) {
+          yvec_d[isoot + n] = soot_in(i, j, k, n);
+          udata->soot_src[n] = soot_src_in(i, j, k, n);
+        }
+        sd->convertToMol(yvec_d + isoot);
+        sd->convertToMol(udata->soot_src);
+        sd->clipMoments(yvec_d + isoot);
+        yvec_d[ienrg] = 0.0;
+        udata->mu = mu_in(i, j, k) * sd->sc.mu_conv;
+
+        CVodeReInit(cvode_mem, time_start, y);
+
+        BL_PROFILE_VAR("Pele::ReactorCvode::react_soot():CVode", AroundCVODE);
+        CVode(cvode_mem, time_final, y, &CvodeActual_time_final, CV_NORMAL);
+        BL_PROFILE_VAR_STOP(AroundCVODE);
+
+        if (captured_verbose > 1) {
+          print_final_stats(cvode_mem, LS != nullptr);
+        }
+
+        long int nfe = 0;
+        long int nfeLS = 0;
+        CVodeGetNumRhsEvals(cvode_mem, &nfe);
+        if (LS != nullptr) {
+          CVodeGetNumLinRhsEvals(cvode_mem, &nfeLS);
+        }
+        const long int nfe_tot = nfe + nfeLS;
+
+        // The gas energy includes the energy exchanged with the soot
+        udata->rhoe_init += yvec_d[ienrg];
+        utils::box_unflatten<Ordering>(
+          icell, i, j, k, ncells, captured_reactor_type,
+          captured_clean_init_massfrac, rY_in, T_in, rEner_in, rEner_src_in,
+          FC_in, yvec_d, &udata->rhoe_init, nfe_tot, dt_react);
+        sd->clipMoments(yvec_d + isoot);
+        sd->convertFromMol(yvec_d + isoot);
+        for (int n = 0; n < NUM_SOOT_MOMENTS + 1; n++) {
+          soot_in(i, j, k, n) = yvec_d[isoot + n];
+        }
+      } else {
+        FC_in(i, j, k, 0) = 0.0;
+      }
+    });
+
+#ifdef MOD_REACTOR
+  dt_react = time_start - time_final;
+  time += dt_react;
+#endif
+
+  // Clean up
+  N_VDestroy(y);
+  CVodeFree(&cvode_mem);
+  if (LS != nullptr) {
+    SUNLinSolFree(LS);
+  }
+  if (NLS != nullptr) {
+    SUNNonlinSolFree(NLS);
+  }
+  if (A != nullptr) {
+    SUNMatDestroy(A);
+  }
+  delete udata;
+
+  // Dummy, as for react() on CPU
+  return 20;
+#endif
+}
+#endif
+
 int
 ReactorCvode::react(
   sunrealtype* rY_in,
@@ -1719,6 +1989,23 @@ ReactorCvode::cF_RHS(
   return 0;
 }
 
+#if defined(SOOT_MODEL) && !defined(AMREX_USE_GPU)
+int
+ReactorCvode::cF_RHS_soot(
+  sunrealtype t, N_Vector y_in, N_Vector ydot_in, void* user_data)
+{
+  BL_PROFILE("Pele::ReactorCvode::cF_RHS_soot()");
+  amrex::Real* yvec_d = N_VGetArrayPointer(y_in);
+  amrex::Real* ydot_d = N_VGetArrayPointer(ydot_in);
+  auto* udata = static_cast<CVODESootUserData*>(user_data);
+  utils::fKernelSpecSoot(
+    t - udata->time_init, udata->reactor_type, yvec_d, ydot_d,
+    udata->rhoe_init, udata->rhoesrc_ext, udata->rYsrc_ext, udata->soot_src,
+    udata->mu, udata->soot_data);
+  return 0;
+}
+#endif
+
 void
 ReactorCvode::freeUserData(CVODEUserData* data_wk)
 {
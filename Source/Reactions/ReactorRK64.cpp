@@ -319,4 +319,195 @@ ReactorRK64::react(
   return (int(avgsteps / amrex::Real(ncells)));
 }
 
+#ifdef SOOT_MODEL
+int
+ReactorRK64::react_soot(
+  const amrex::Box& box,
+  amrex::Array4<amrex::Real> const& rY_in,
+  amrex::Array4<amrex::Real> const& rYsrc_in,
+  amrex::Array4<amrex::Real> const& T_in,
+  amrex::Array4<amrex::Real> const& rEner_in,
+  amrex::Array4<amrex::Real> const& rEner_src_in,
+  amrex::Array4<amrex::Real> const& FC_in,
+  amrex::Array4<int> const& /*mask*/,
+  amrex::Array4<amrex::Real> const& soot_in,
+  amrex::Array4<const amrex::Real> const& soot_src_in,
+  amrex::Array4<const amrex::Real> const& mu_in,
+  const SootODEData& soot_data,
+  amrex::Real& dt_react,
+  amrex::Real& time
+#ifdef AMREX_USE_GPU
+  ,
+  amrex::gpuStream_t /*stream*/
+#endif
+)
+{
+  BL_PROFILE("Pele::ReactorRK64::react_soot()");
+
+  amrex::Real time_init = time;
+  amrex::Real time_out = time + dt_react;
+  const amrex::Real tinyval = 1e-50;
+
+  // capture reactor type
+  const int captured_reactor_type = m_reactor_type;
+  const int captured_nsubsteps_guess = rk64_nsubsteps_guess;
+  const int captured_nsubsteps_min = rk64_nsubsteps_min;
+  const int captured_nsubsteps_max = rk64_nsubsteps_max;
+  const amrex::Real captured_abstol = absTol;
+  const auto* leosparm = m_eosparm;
+  RK64Params rkp;
+
+  int ncells = static_cast<int>(box.numPts());
+  const auto len = amrex::length(box);
+  const auto lo = amrex::lbound(box);
+
+  amrex::Gpu::DeviceVector<int> v_nsteps(ncells, 0);
+  int* d_nsteps = v_nsteps.data();
+
+  amrex::ParallelFor(box, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+    // Species, temperature, then the soot variables
+    constexpr int isoot = NUM_SPECIES + 1;
+    constexpr int neq = NUM_SPECIES + 1 + NUM_SOOT_ODE;
+    amrex::Real soln_reg[neq] = {0.0};
+    amrex::Real carryover_reg[neq] = {0.0};
+    amrex::Real error_reg[neq] = {0.0};
+    amrex::Real ydot[neq] = {0.0};
+    amrex::Real rYsrc_ext[NUM_SPECIES] = {0.0};
+    amrex::Real soot_src[NUM_SOOT_MOMENTS + 1] = {0.0};
+    amrex::Real current_time = time_init;
+    const SootData* sd = soot_data.sd;
+
+    auto eos = pele::physics::PhysicsType::eos(leosparm);
+    for (int sp = 0; sp < NUM_SPECIES; sp++) {
+      soln_reg[sp] = rY_in(i, j, k, sp);
+    }
+    amrex::Real rho = 0.0, rho_inv = 0.0;
+    amrex::Real mass_frac[NUM_SPECIES] = {0.0};
+    eos.RY2RRinvY(soln_reg, rho, rho_inv, mass_frac);
+
+    amrex::Real temp = T_in(i, j, k, 0);
+
+    amrex::Real Enrg_loc = rEner_in(i, j, k, 0) * rho_inv;
+    if (captured_reactor_type == ReactorTypes::e_reactor_type) {
+      eos.REY2T(rho, Enrg_loc, mass_frac, temp);
+    } else if (captured_reactor_type == ReactorTypes::h_reactor_type) {
+      eos.RHY2T(rho, Enrg_loc, mass_frac, temp);
+    } else {
+      amrex::Abort("Wrong reactor type. Choose between 1 (e) or 2 (h).");
+    }
+    soln_reg[NUM_SPECIES] = temp;
+
+    // Moments and their forcing in mol of C
+    for (int n = 0; n < NUM_SOOT_MOMENTS + 1; n++) {
+      soln_reg[isoot + n] = soot_in(i, j, k, n);
+      soot_src[n] = soot_src_in(i, j, k, n);
+    }
+    sd->convertToMol(soln_reg + isoot);
+    sd->convertToMol(soot_src);
+    sd->clipMoments(soln_reg + isoot);
+    soln_reg[neq - 1] = 0.0;
+    for (int sp = 0; sp < neq; sp++) {
+      carryover_reg[sp] = soln_reg[sp];
+    }
+    const amrex::Real mu = mu_in(i, j, k) * sd->sc.mu_conv;
+
+    amrex::Real dt_rk = dt_react / amrex::Real(captured_nsubsteps_guess);
+    amrex::Real dt_rk_min = dt_react / amrex::Real(captured_nsubsteps_max);
+    amrex::Real dt_rk_max = dt_react / amrex::Real(captured_nsubsteps_min);
+
+    const amrex::Real rhoe_init = rEner_in(i, j, k, 0);
+    const amrex::Real rhoesrc_ext = rEner_src_in(i, j, k, 0);
+
+    for (int sp = 0; sp < NUM_SPECIES; sp++) {
+      rYsrc_ext[sp] = rYsrc_in(i, j, k, sp);
+    }
+
+    int nsteps = 0;
+    amrex::Real change_factor;
+    while (current_time < time_out) {
+      for (amrex::Real& sp : error_reg) {
+        sp = 0.0;
+      }
+      for (int stage = 0; stage < rkp.nstages_rk64; stage++) {
+        utils::fKernelSpecSoot(
+          current_time - time_init, captured_reactor_type, soln_reg, ydot,
+          rhoe_init, rhoesrc_ext, rYsrc_ext, soot_src, mu, soot_data,
+          leosparm);
+
+        for (int sp = 0; sp < neq; sp++) {
+          error_reg[sp] += rkp.err_rk64[stage] * dt_rk * ydot[sp];
+          soln_reg[sp] =
+            carryover_reg[sp] + rkp.alpha_rk64[stage] * dt_rk * ydot[sp];
+          carryover_reg[sp] =
+            soln_reg[sp] + rkp.beta_rk64[stage] * dt_rk * ydot[sp];
+        }
+      }
+
+      current_time += dt_rk;
+      nsteps++;
+
+      // The soot errors are scaled by their tolerances
+      amrex::Real max_err = tinyval;
+      for (int sp = 0; sp < neq; sp++) {
+        const amrex::Real err =
+          (sp < isoot) ? fabs(error_reg[sp])
+                       : fabs(error_reg[sp]) * captured_abstol /
+                           soot_data.abs_tol[sp - isoot];
+        max_err = err > max_err ? err : max_err;
+      }
+
+      if (max_err < captured_abstol) {
+        change_factor =
+          rkp.betaerr_rk64 * pow((captured_abstol / max_err), rkp.exp1_rk64);
+        dt_rk = amrex::min<amrex::Real>(dt_rk_max, dt_rk * change_factor);
+      } else {
+        change_factor =
+          rkp.betaerr_rk64 * pow((captured_abstol / max_err), rkp.exp2_rk64);
+        dt_rk = amrex::max<amrex::Real>(dt_rk_min, dt_rk * change_factor);
+      }
+      // Don't overstep the integration time
+      dt_rk = amrex::min<amrex::Real>(dt_rk, time_out - current_time);
+    }
+
+    // copy data back
+    int icell = (k - lo.z) * len.x * len.y + (j - lo.y) * len.x + (i - lo.x);
+    d_nsteps[icell] = nsteps;
+    for (int sp = 0; sp < NUM_SPECIES; sp++) {
+      rY_in(i, j, k, sp) = soln_reg[sp];
+    }
+    eos.RY2RRinvY(soln_reg, rho, rho_inv, mass_frac);
+
+    temp = soln_reg[NUM_SPECIES];
+    rEner_in(i, j, k, 0) =
+      rhoe_init + dt_react * rhoesrc_ext + soln_reg[neq - 1];
+    Enrg_loc = rEner_in(i, j, k, 0) * rho_inv;
+
+    if (captured_reactor_type == ReactorTypes::e_reactor_type) {
+      eos.REY2T(rho, Enrg_loc, mass_frac, temp);
+    } else if (captured_reactor_type == ReactorTypes::h_reactor_type) {
+      eos.RHY2T(rho, Enrg_loc, mass_frac, temp);
+    } else {
+      amrex::Abort("Wrong reactor type. Choose between 1 (e) or 2 (h).");
+    }
+    T_in(i, j, k, 0) = temp;
+    FC_in(i, j, k, 0) = nsteps;
+
+    sd->clipMoments(soln_reg + isoot);
+    sd->convertFromMol(soln_reg + isoot);
+    for (int n = 0; n < NUM_SOOT_MOMENTS + 1; n++) {
+      soot_in(i, j, k, n) = soln_reg[isoot + n];
+    }
+  });
+
+#ifdef MOD_REACTOR
+  time = time_out;
+#endif
+
+  const int avgsteps = amrex::Reduce::Sum<int>(
+    ncells, [=] AMREX_GPU_DEVICE(int i) noexcept -> int { return d_nsteps[i]; },
+    0);
+  return (int(avgsteps / amrex::Real(ncells)));
+}
+#endif
+
 } // namespace pele::physics::reactions
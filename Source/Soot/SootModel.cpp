@@ -1,5 +1,6 @@
 
 // AMReX include statements
+#include <AMReX_DenseBins.H>
 #include <AMReX_Reduce.H>
 
 // PelePhysics include statements
@@ -10,6 +11,246 @@
 
 using namespace amrex;
 
+// Solve A x = b by Gaussian elimination with partial pivoting, x is
+// returned in b. Returns false if A is singular
+template <int N>
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE bool
+sootSolveDense(Real A[N][N], Real b[N])
+{
+  for (int c = 0; c < N; ++c) {
+    int piv = c;
+    for (int r = c + 1; r < N; ++r) {
+      if (std::abs(A[r][c]) > std::abs(A[piv][c])) {
+        piv = r;
+      }
+    }
+    if (A[piv][c] == 0. || !std::isfinite(A[piv][c])) {
+      return false;
+    }
+    if (piv != c) {
+      for (int cc = c; cc < N; ++cc) {
+        amrex::Swap(A[c][cc], A[piv][cc]);
+      }
+      amrex::Swap(b[c], b[piv]);
+    }
+    const Real inv_diag = 1. / A[c][c];
+    for (int r = c + 1; r < N; ++r) {
+      const Real fact = A[r][c] * inv_diag;
+      for (int cc = c + 1; cc < N; ++cc) {
+        A[r][cc] -= fact * A[c][cc];
+      }
+      b[r] -= fact * b[c];
+    }
+  }
+  for (int r = N - 1; r >= 0; --r) {
+    Real val = b[r];
+    for (int cc = r + 1; cc < N; ++cc) {
+      val -= A[r][cc] * b[cc];
+    }
+    b[r] = val / A[r][r];
+  }
+  return true;
+}
+
+// Integrate the moments (mol of C) and gas species concentrations over dt
+// with explicit Euler subcycles, the subcycle size is reduced from
+// dt / nsub_init when a moment would decrease too fast
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
+sootExplicitIntegrate(
+  const SootData* sd,
+  const SootReaction* sr,
+  const Real dt,
+  const int nsub_init,
+  const int nsubMAX,
+  const Real T,
+  const Real mu,
+  const Real molarMass,
+  const Real convT,
+  const Real betaNucl,
+  const Real colConst,
+  const Real* mw_fluid,
+  Real& rho,
+  Real* xi_n,
+  Real* moments,
+  int& nevals)
+{
+  Real omega_src[NUM_SOOT_GS] = {0.0};
+  Real mom_src[NUM_SOOT_MOMENTS + 1] = {0.0};
+  /*
+    These are the values inside the terms in fracMom
+    momFV[NUM_SOOT_MOMENTS] - Weight of the delta function
+    momFV[NUM_SOOT_MOMENTS+1] - modeCoef
+    where modeCoef signifies the number of modes to be used
+    If the moments are effectively zero, modeCoef = 0 and only 1 mode is used
+    Otherwise, modeCoef = 1 and both modes are used
+    The rest of the momFV values are the logarithms of the factors used in
+    fracMom, see SootData::computeFracMomVect
+  */
+  Real mom_fv[NUM_SOOT_MOMENTS + 2];
+  int nsub = nsub_init;
+  Real mindt = dt / Real(nsubMAX);
+  Real sootdt = dt / Real(nsub);
+  int isub = 1;
+  Real tstart = 0.;
+  // Subcycling
+  while (tstart < dt && isub < nsubMAX + 1) {
+    sd->computeSrcTerms(
+      T, mu, rho, molarMass, convT, betaNucl, colConst, xi_n, omega_src,
+      moments, mom_src, mom_fv, sr);
+    ++nevals;
+    // Estimate subcycling time step size
+    Real rate = 1.;
+    for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
+      rate = amrex::max(rate, 1.05 * -sootdt * mom_src[mom] / moments[mom]);
+    }
+    if (rate > 1.) {
+      sootdt = amrex::max(sootdt / rate, mindt);
+    }
+    if (tstart + sootdt > dt) {
+      sootdt = dt - tstart;
+    }
+    // Update species concentrations within subcycle
+    for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+      xi_n[sp] += sootdt * omega_src[sp];
+      rho += sootdt * omega_src[sp] * mw_fluid[sp];
+      omega_src[sp] = 0.; // Reset omega source
+    }
+    // Update moments within subcycle
+    for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
+      moments[mom] += sootdt * mom_src[mom];
+      mom_src[mom] = 0.; // Reset moment source
+    }
+    sd->clipMoments(moments);
+    tstart += sootdt;
+    isub++;
+  }
+  // If not finished with the time step, add remaining source
+  if (tstart < dt) {
+    Real remdt = dt - tstart;
+    sd->computeSrcTerms(
+      T, mu, rho, molarMass, convT, betaNucl, colConst, xi_n, omega_src,
+      moments, mom_src, mom_fv, sr);
+    ++nevals;
+    // Update species concentrations within subcycle
+    for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+      xi_n[sp] += remdt * omega_src[sp];
+      rho += remdt * omega_src[sp] * mw_fluid[sp];
+    }
+    for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
+      moments[mom] += remdt * mom_src[mom];
+    }
+    sd->clipMoments(moments);
+  }
+}
+
+// Integrate the moments (mol of C) and gas species concentrations y over dt
+// with nstep linearly implicit Euler steps of size h,
+//   (I - h J) dy = h f(y),
+// where J is the finite difference Jacobian of the sources f, evaluated
+// once at the start of dt. Returns false if a step gives a singular
+// system, non-finite values or negative concentrations
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE bool
+sootImplicitIntegrate(
+  const SootData* sd,
+  const SootReaction* sr,
+  const Real dt,
+  const int nstep,
+  const Real T,
+  const Real mu,
+  const Real molarMass,
+  const Real convT,
+  const Real betaNucl,
+  const Real colConst,
+  const Real Xcutoff,
+  const Real* mw_fluid,
+  Real& rho,
+  Real* xi_n,
+  Real* moments,
+  int& nevals)
+{
+  constexpr int nmom = NUM_SOOT_MOMENTS + 1;
+  constexpr int nvar = nmom + NUM_SOOT_GS;
+  // Moments followed by the gas species concentrations
+  Real yvec[nvar];
+  Real fvec[nvar];
+  Real fpert[nvar];
+  Real jac[nvar][nvar];
+  Real amat[nvar][nvar];
+  Real mom_fv[NUM_SOOT_MOMENTS + 2];
+  for (int n = 0; n < nmom; ++n) {
+    yvec[n] = moments[n];
+  }
+  for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+    yvec[nmom + sp] = xi_n[sp];
+  }
+  auto eval_src = [&](Real* y, Real* f) {
+    for (int n = 0; n < nvar; ++n) {
+      f[n] = 0.;
+    }
+    sd->computeSrcTerms(
+      T, mu, rho, molarMass, convT, betaNucl, colConst, y + nmom, f + nmom, y,
+      f, mom_fv, sr);
+    ++nevals;
+  };
+  eval_src(yvec, fvec);
+  // One sided differences, perturbations are bounded below by the small
+  // moment values and the concentration cutoff
+  const Real sqrt_eps = std::sqrt(std::numeric_limits<Real>::epsilon());
+  for (int c = 0; c < nvar; ++c) {
+    const Real yfloor = (c < nmom) ? sd->smallMoms[c] : Xcutoff;
+    const Real del = sqrt_eps * amrex::max(std::abs(yvec[c]), yfloor);
+    const Real ysave = yvec[c];
+    yvec[c] += del;
+    eval_src(yvec, fpert);
+    yvec[c] = ysave;
+    for (int r = 0; r < nvar; ++r) {
+      jac[r][c] = (fpert[r] - fvec[r]) / del;
+    }
+  }
+  const Real h = dt / static_cast<Real>(nstep);
+  for (int istep = 0; istep < nstep; ++istep) {
+    if (istep > 0) {
+      eval_src(yvec, fvec);
+    }
+    for (int r = 0; r < nvar; ++r) {
+      for (int c = 0; c < nvar; ++c) {
+        amat[r][c] = -h * jac[r][c];
+      }
+      amat[r][r] += 1.;
+      fvec[r] *= h;
+    }
+    if (!sootSolveDense<nvar>(amat, fvec)) {
+      return false;
+    }
+    for (int n = 0; n < nvar; ++n) {
+      yvec[n] += fvec[n];
+      if (!std::isfinite(yvec[n])) {
+        return false;
+      }
+    }
+    for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+      Real& xi = yvec[nmom + sp];
+      if (xi < 0.) {
+        // Round-off below the cutoff is removed, larger undershoots fail
+        if (xi < -Xcutoff) {
+          return false;
+        }
+        fvec[nmom + sp] -= xi;
+        xi = 0.;
+      }
+      rho += fvec[nmom + sp] * mw_fluid[sp];
+    }
+    sd->clipMoments(yvec);
+  }
+  for (int n = 0; n < nmom; ++n) {
+    moments[n] = yvec[n];
+  }
+  for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+    xi_n[sp] = yvec[nmom + sp];
+  }
+  return true;
+}
+
 // Default constructor
 SootModel::SootModel()
   : m_sootVarName(NUM_SOOT_MOMENTS + 1, ""), m_gasSpecNames(NUM_SOOT_GS, "")
@@ -139,8 +380,33 @@ SootModel::readSootParams()
   m_numSubcycles = 5;
 #endif
   pp.query("num_subcycles", m_numSubcycles);
+  std::string integrator = "explicit";
+  pp.query("integrator", integrator);
+  if (integrator == "explicit") {
+    m_integrator = 0;
+  } else if (integrator == "implicit") {
+    m_integrator = 1;
+  } else {
+    Abort("soot.integrator must be explicit or implicit");
+  }
+  pp.query("implicit_steps", m_implicitSteps);
+  if (m_implicitSteps < 1) {
+    Abort("soot.implicit_steps must be at least 1");
+  }
+  // Thresholds of the cells where the source terms are integrated
+  pp.query("active_pah_conc", m_activePAHConc);
+  pp.query("active_num_dens", m_activeNumDens);
   // Determines if mass is conserved by adding lost mass to H2
   pp.query("conserve_mass", m_conserveMass);
+  // Scales of the soot variables in the chemistry reactors
+  pp.query("ode_typ_num_dens", m_odeTypNumDens);
+  pp.query("ode_typ_num_carbon", m_odeTypNumC);
+  pp.query("ode_atol", m_odeAtolFact);
+  if (m_odeTypNumDens <= 0. || m_odeTypNumC < 1. || m_odeAtolFact <= 0.) {
+    Abort(
+      "soot.ode_typ_num_dens, ode_typ_num_carbon and ode_atol must be "
+      "positive");
+  }
   m_readSootParams = true;
 }
 
@@ -157,6 +423,8 @@ SootModel::defineMemberData(const Real dimerVol)
   Real nuclSurf = std::pow(nuclVol, 2. / 3.);
   m_sootData->nuclVol = nuclVol;
   m_sootData->nuclSurf = nuclSurf;
+  m_sootData->logNuclVol = std::log(nuclVol);
+  m_sootData->logNuclSurf = std::log(nuclSurf);
   // Compute V_nucl and V_dimer to fractional powers
   for (int i = 0; i < 9; ++i) {
     Real exponent = 2. * (Real)i - 3.;
@@ -231,7 +499,8 @@ SootModel::computeSootSourceTerm(
   Array4<Real> const& soot_state,
   const Real /*time*/,
   const Real dt,
-  const bool pres_term) const
+  const bool pres_term,
+  SootSrcStats* stats) const
 {
   AMREX_ASSERT(m_memberDataDefined);
   AMREX_ASSERT(m_setIndx);
@@ -242,6 +511,9 @@ SootModel::computeSootSourceTerm(
   }
   const int nsub_init = m_numSubcycles;
   const int nsubMAX = m_maxSubcycles;
+  const bool useImplicit = (m_integrator == 1);
+  const int nimpl = m_implicitSteps;
+  const Real Xcutoff = m_Xcutoff;
   // Primitive components
   const int qRhoIndx = m_sootIndx.qRhoIndx;
   const int qTempIndx = m_sootIndx.qTempIndx;
@@ -264,13 +536,70 @@ SootModel::computeSootSourceTerm(
   const SootData* sd = d_sootData;
   const SootReaction* sr = d_sootReact;
   SootConst sc;
+  // Number of solved cells, source evaluations and implicit fallbacks
+  const bool do_counts = (stats != nullptr);
+  Gpu::DeviceVector<int> counts_d(do_counts ? 3 : 0, 0);
+  int* counts = do_counts ? counts_d.data() : nullptr;
+  // Compact the cells above the temperature cutoff with PAH or soot above
+  // the activity thresholds. The active cells are ordered by a cost estimate,
+  // the decades of M00 above the threshold since coagulation and oxidation
+  // of existing soot shorten the subcycles, most expensive first
+  const int ncost = 8;
+  const int nbox = static_cast<int>(vbox.numPts());
+  Gpu::DeviceVector<int> cell_bin_d(nbox);
+  int* cell_bin = cell_bin_d.data();
+  Real mw_all[NUM_SPECIES];
+  pele::physics::PhysicsType::eos().molecular_weight(mw_all);
+  const Real mwPAH = mw_all[m_PAHindx];
+  const int PAHindx = m_PAHindx;
+  const Real activePAH = m_activePAHConc;
+  const Real activeNum = m_activeNumDens / pele::physics::Constants::Avna;
+  const Real M00conv = m_sootData->unitConv[0];
   amrex::ParallelFor(vbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+    int bin = ncost;
+    if (Qstate(i, j, k, qTempIndx) > Tcutoff) {
+#ifdef PELELM_USE_SOOT
+      const Real rhoPAH = Qstate(i, j, k, qSpecIndx + PAHindx) * sc.rho_conv;
+#else
+      const Real rhoPAH =
+        Qstate(i, j, k, qRhoIndx) * Qstate(i, j, k, qSpecIndx + PAHindx);
+#endif
+      const Real xiPAH = rhoPAH / mwPAH;
+      const Real M00 = Qstate(i, j, k, qSootIndx) / M00conv;
+      if (xiPAH > activePAH || M00 > activeNum) {
+        int cost = 0;
+        if (M00 > activeNum && activeNum > 0.) {
+          cost = amrex::min(
+            ncost - 1, static_cast<int>(std::log10(M00 / activeNum)));
+        }
+        bin = ncost - 1 - cost;
+      }
+    }
+    cell_bin[vbox.index(IntVect(AMREX_D_DECL(i, j, k)))] = bin;
+  });
+  DenseBins<int> bins;
+  bins.build(
+    nbox, cell_bin, ncost + 1,
+    [=] AMREX_GPU_DEVICE(const int& bin) noexcept -> unsigned int {
+      return static_cast<unsigned int>(bin);
+    });
+  const auto* perm = bins.permutationPtr();
+  const int nactive = Reduce::Sum<int>(
+    nbox,
+    [=] AMREX_GPU_DEVICE(int n) noexcept -> int {
+      return static_cast<int>(cell_bin[n] < ncost);
+    },
+    0);
+  amrex::ParallelFor(nactive, [=] AMREX_GPU_DEVICE(int n) noexcept {
+    const Dim3 iv = vbox.atOffset(perm[n]).dim3();
+    const int i = iv.x;
+    const int j = iv.y;
+    const int k = iv.z;
     auto eos = pele::physics::PhysicsType::eos();
     GpuArray<Real, NUM_SPECIES> mw_fluidF;
     GpuArray<Real, NUM_SOOT_GS> mw_fluid;
     eos.molecular_weight(mw_fluidF.data());
     GpuArray<Real, NUM_SPECIES> Hi;
-    GpuArray<Real, NUM_SOOT_GS> omega_src;
     GpuArray<Real, NUM_SPECIES> rho_YF;
     // Molar concentrations (mol/cm^3)
     GpuArray<Real, NUM_SOOT_GS> xi_n;
@@ -279,161 +608,176 @@ SootModel::computeSootSourceTerm(
     GpuArray<Real, NUM_SOOT_MOMENTS + 1> mom0;
     GpuArray<Real, NUM_SOOT_MOMENTS + 1> moments;
     Real* momentsPtr = moments.data();
-    /*
-      These are the values inside the terms in fracMom
-      momFV[NUM_SOOT_MOMENTS] - Weight of the delta function
-      momFV[NUM_SOOT_MOMENTS+1] - modeCoef
-      where modeCoef signifies the number of modes to be used
-      If the moments are effectively zero, modeCoef = 0 and only 1 mode is used
-      Otherwise, modeCoef = 1 and both modes are used
-      The rest of the momFV values are used in fracMom fact1 = momFV[0],
-      fact2 = momFV[1]^volOrd, fact2 = momFV[2]^surfOrd, etc.
-    */
-    GpuArray<Real, NUM_SOOT_MOMENTS + 2> mom_fv;
-    Real* mom_fvPtr = mom_fv.data();
-    // Array of source terms for moment equations
-    GpuArray<Real, NUM_SOOT_MOMENTS + 1> mom_src;
-    Real* mom_srcPtr = mom_src.data();
     Real rho = Qstate(i, j, k, qRhoIndx) * sc.rho_conv;
     const Real T = Qstate(i, j, k, qTempIndx);
-    if (T > Tcutoff) {
-      // Dynamic viscosity
-      const Real mu = coeff_mu(i, j, k) * sc.mu_conv;
-      // Compute species enthalpy
-      eos.T2Hi(T, Hi.data());
-      // Extract mass fractions for gas phases corresponding to GasSpecIndx
-      for (int sp = 0; sp < NUM_SPECIES; ++sp) {
-        const int peleIndx = qSpecIndx + sp;
-        // State provided by PeleLM is the concentration, rhoY
+    // Dynamic viscosity
+    const Real mu = coeff_mu(i, j, k) * sc.mu_conv;
+    // Compute species enthalpy
+    eos.T2Hi(T, Hi.data());
+    // Extract mass fractions for gas phases corresponding to GasSpecIndx
+    for (int sp = 0; sp < NUM_SPECIES; ++sp) {
+      const int peleIndx = qSpecIndx + sp;
+      // State provided by PeleLM is the concentration, rhoY
 #ifdef PELELM_USE_SOOT
-        rho_YF[sp] = amrex::max(0., Qstate(i, j, k, peleIndx) * sc.rho_conv);
+      rho_YF[sp] = amrex::max(0., Qstate(i, j, k, peleIndx) * sc.rho_conv);
 #else
-        rho_YF[sp] = amrex::max(0., rho * Qstate(i, j, k, peleIndx));
+      rho_YF[sp] = amrex::max(0., rho * Qstate(i, j, k, peleIndx));
 #endif
+    }
+    // Compute the average molar mass (g/mol)
+    Real molarMass = 0.;
+    for (int sp = 0; sp < NUM_SPECIES; ++sp) {
+      molarMass += rho_YF[sp] / mw_fluidF[sp];
+    }
+    molarMass = rho / molarMass;
+    // Extract moment values
+    for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
+      const int peleIndx = qSootIndx + mom;
+      moments[mom] = Qstate(i, j, k, peleIndx);
+      mom0[mom] = moments[mom];
+    }
+    for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+      const int spcc = sd->refIndx[sp];
+      mw_fluid[sp] = mw_fluidF[spcc];
+      xi_n[sp] = rho_YF[spcc] / mw_fluid[sp];
+    }
+    // Convert moments from CGS to mol of C
+    sd->convertToMol(momentsPtr);
+    // Compute constant values used throughout
+    // (R*T*Pi/(2*A*rho_soot))^(1/2)
+    const Real convT = std::sqrt(sc.colFact * T);
+    // Constant for free molecular collisions
+    const Real colConst =
+      convT * sc.colFactPi23 * sc.colFact16 * pele::physics::Constants::Avna;
+    // Collision frequency between two dimer in the free
+    // molecular regime with van der Waals enhancement
+    // Units: cm^3/mol-s
+    sd->clipMoments(momentsPtr);
+    Real RT = pele::physics::Constants::RU * T;
+    const Real betaNucl = convT * betaNF;
+    int nevals = 0;
+    int fallback = 0;
+    if (useImplicit) {
+      // Keep the initial state in case the implicit steps fail
+      const Real rho0 = rho;
+      GpuArray<Real, NUM_SOOT_GS> xi0 = xi_n;
+      GpuArray<Real, NUM_SOOT_MOMENTS + 1> momMol = moments;
+      if (!sootImplicitIntegrate(
+            sd, sr, dt, nimpl, T, mu, molarMass, convT, betaNucl, colConst,
+            Xcutoff, mw_fluid.data(), rho, xi_n.data(), momentsPtr, nevals)) {
+        fallback = 1;
+        rho = rho0;
+        xi_n = xi0;
+        moments = momMol;
       }
-      // Compute the average molar mass (g/mol)
-      Real molarMass = 0.;
-      for (int sp = 0; sp < NUM_SPECIES; ++sp) {
-        molarMass += rho_YF[sp] / mw_fluidF[sp];
-      }
-      molarMass = rho / molarMass;
-      // Extract moment values
-      for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
-        const int peleIndx = qSootIndx + mom;
-        moments[mom] = Qstate(i, j, k, peleIndx);
-        mom0[mom] = moments[mom];
-        mom_src[mom] = 0.;
-      }
-      for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
-        const int spcc = sd->refIndx[sp];
-        mw_fluid[sp] = mw_fluidF[spcc];
-        xi_n[sp] = rho_YF[spcc] / mw_fluid[sp];
-        // Reset the reaction source term
-        omega_src[sp] = 0.;
-      }
-      // Convert moments from CGS to mol of C
-      sd->convertToMol(momentsPtr);
-      // Compute constant values used throughout
-      // (R*T*Pi/(2*A*rho_soot))^(1/2)
-      const Real convT = std::sqrt(sc.colFact * T);
-      // Constant for free molecular collisions
-      const Real colConst =
-        convT * sc.colFactPi23 * sc.colFact16 * pele::physics::Constants::Avna;
-      // Collision frequency between two dimer in the free
-      // molecular regime with van der Waals enhancement
-      // Units: cm^3/mol-s
-      sd->clipMoments(momentsPtr);
-      Real RT = pele::physics::Constants::RU * T;
-      const Real betaNucl = convT * betaNF;
-      int nsub = nsub_init;
-      Real mindt = dt / Real(nsubMAX);
-      Real sootdt = dt / Real(nsub);
-      int isub = 1;
-      Real tstart = 0.;
-      // Subcycling
-      while (tstart < dt && isub < nsubMAX + 1) {
-        sd->computeSrcTerms(
-          T, mu, rho, molarMass, convT, betaNucl, colConst, xi_n.data(),
-          omega_src.data(), momentsPtr, mom_srcPtr, mom_fvPtr, sr);
-        // Estimate subcycling time step size
-        Real rate = 1.;
-        for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
-          rate = amrex::max(rate, 1.05 * -sootdt * mom_src[mom] / moments[mom]);
-        }
-        if (rate > 1.) {
-          sootdt = amrex::max(sootdt / rate, mindt);
-        }
-        if (tstart + sootdt > dt) {
-          sootdt = dt - tstart;
-        }
-        // Update species concentrations within subcycle
-        for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
-          xi_n[sp] += sootdt * omega_src[sp];
-          rho += sootdt * omega_src[sp] * mw_fluid[sp];
-          omega_src[sp] = 0.; // Reset omega source
-        }
-        // Update moments within subcycle
-        for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
-          moments[mom] += sootdt * mom_src[mom];
-          mom_src[mom] = 0.; // Reset moment source
-        }
-        sd->clipMoments(momentsPtr);
-        tstart += sootdt;
-        isub++;
-      }
-      // If not finished with the time step, add remaining source
-      if (tstart < dt) {
-        Real remdt = dt - tstart;
-        sd->computeSrcTerms(
-          T, mu, rho, molarMass, convT, betaNucl, colConst, xi_n.data(),
-          omega_src.data(), momentsPtr, mom_srcPtr, mom_fvPtr, sr);
-        // Update species concentrations within subcycle
-        for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
-          xi_n[sp] += remdt * omega_src[sp];
-          rho += remdt * omega_src[sp] * mw_fluid[sp];
-        }
-        for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
-          moments[mom] += remdt * mom_src[mom];
-        }
-        sd->clipMoments(momentsPtr);
-      }
-      sd->convertFromMol(momentsPtr);
-      for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
-        const int peleIndx = sootIndx + mom;
-        soot_state(i, j, k, peleIndx) += (moments[mom] - mom0[mom]) / dt;
-      }
-      Real rho_src = 0.;
-      Real eng_src = 0.;
-      Real p_src = 0.;
-      for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
-        // Convert from local gas species index to global gas species index
-        const int spcc = sd->refIndx[sp];
-        const int peleIndx = specIndx + spcc;
-        Real newrhoY = xi_n[sp] * mw_fluid[sp];
-        Real omegai = (newrhoY - rho_YF[spcc]) / dt;
-        soot_state(i, j, k, peleIndx) += omegai * sc.mass_src_conv;
-        rho_src += omegai;
-        eng_src += omegai * Hi[spcc];
-        p_src -= omegai * RT / mw_fluid[sp];
-      }
-      if (conserveMass) {
-        // Difference between mass lost from fluid and mass gained to soot
-        Real diff_vol = soot_state(i, j, k, sootIndx + 1) * sd->unitConv[1];
-        Real del_rho_dot = rho_src + diff_vol * sc.SootDensity;
-        // Add that mass to H2
-        soot_state(i, j, k, absorbIndxP) -= del_rho_dot * sc.mass_src_conv;
-        rho_src -= del_rho_dot;
-        eng_src -= del_rho_dot * Hi[absorbIndxN];
-        p_src += del_rho_dot * RT / mw_fluidF[absorbIndxN];
-      }
-      if (pres_term) {
-        eng_src += p_src;
-      }
-      // Add density source term
-      soot_state(i, j, k, rhoIndx) += rho_src * sc.mass_src_conv;
-      soot_state(i, j, k, engIndx) += eng_src * sc.eng_src_conv;
     }
+    if (!useImplicit || fallback == 1) {
+      sootExplicitIntegrate(
+        sd, sr, dt, nsub_init, nsubMAX, T, mu, molarMass, convT, betaNucl,
+        colConst, mw_fluid.data(), rho, xi_n.data(), momentsPtr, nevals);
+    }
+    if (counts != nullptr) {
+      Gpu::Atomic::AddNoRet(&counts[0], 1);
+      Gpu::Atomic::AddNoRet(&counts[1], nevals);
+      Gpu::Atomic::AddNoRet(&counts[2], fallback);
+    }
+    sd->convertFromMol(momentsPtr);
+    for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
+      const int peleIndx = sootIndx + mom;
+      soot_state(i, j, k, peleIndx) += (moments[mom] - mom0[mom]) / dt;
+    }
+    Real rho_src = 0.;
+    Real eng_src = 0.;
+    Real p_src = 0.;
+    for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+      // Convert from local gas species index to global gas species index
+      const int spcc = sd->refIndx[sp];
+      const int peleIndx = specIndx + spcc;
+      Real newrhoY = xi_n[sp] * mw_fluid[sp];
+      Real omegai = (newrhoY - rho_YF[spcc]) / dt;
+      soot_state(i, j, k, peleIndx) += omegai * sc.mass_src_conv;
+      rho_src += omegai;
+      eng_src += omegai * Hi[spcc];
+      p_src -= omegai * RT / mw_fluid[sp];
+    }
+    if (conserveMass) {
+      // Difference between mass lost from fluid and mass gained to soot
+      Real diff_vol = soot_state(i, j, k, sootIndx + 1) * sd->unitConv[1];
+      Real del_rho_dot = rho_src + diff_vol * sc.SootDensity;
+      // Add that mass to H2
+      soot_state(i, j, k, absorbIndxP) -= del_rho_dot * sc.mass_src_conv;
+      rho_src -= del_rho_dot;
+      eng_src -= del_rho_dot * Hi[absorbIndxN];
+      p_src += del_rho_dot * RT / mw_fluidF[absorbIndxN];
+    }
+    if (pres_term) {
+      eng_src += p_src;
+    }
+    // Add density source term
+    soot_state(i, j, k, rhoIndx) += rho_src * sc.mass_src_conv;
+    soot_state(i, j, k, engIndx) += eng_src * sc.eng_src_conv;
   });
+  if (do_counts) {
+    Vector<int> counts_h(3);
+    Gpu::copy(
+      Gpu::deviceToHost, counts_d.begin(), counts_d.end(), counts_h.begin());
+    stats->num_box_cells += nbox;
+    stats->num_cells += counts_h[0];
+    stats->num_evals += counts_h[1];
+    stats->num_fallbacks += counts_h[2];
+  }
+}
+
+// Sum the counters over the ranks and print them, must be called on all ranks
+void
+SootModel::reportSrcStats(SootSrcStats stats) const
+{
+  if (m_sootVerbosity < 1) {
+    return;
+  }
+  Long counts[4] = {
+    stats.num_box_cells, stats.num_cells, stats.num_evals,
+    stats.num_fallbacks};
+  ParallelDescriptor::ReduceLongSum(
+    counts, 4, ParallelDescriptor::IOProcessorNumber());
+  const Real num_cells = static_cast<Real>(amrex::max(counts[1], Long(1)));
+  Print() << "SootModel::computeSootSourceTerm(): " << counts[1]
+          << " active cells (fraction "
+          << static_cast<Real>(counts[1]) /
+               static_cast<Real>(amrex::max(counts[0], Long(1)))
+          << "), " << static_cast<Real>(counts[2]) / num_cells
+          << " source evaluations per cell, " << counts[3]
+          << " implicit fallbacks" << std::endl;
+}
+
+// Data to integrate the soot in the chemistry reactors
+SootODEData
+SootModel::getODEData() const
+{
+  AMREX_ASSERT(m_memberDataDefined);
+  SootConst sc;
+  SootODEData sod;
+  sod.sd = d_sootData;
+  sod.sr = d_sootReact;
+  sod.betaNuclFact = m_betaNuclFact;
+  sod.Tcutoff = m_Tcutoff;
+  sod.conserveMass = m_conserveMass;
+  // Moments of a monodisperse population in mol of C, the volume and
+  // surface are normalized by those of a carbon atom
+  const Real typNum = m_odeTypNumDens / pele::physics::Constants::Avna;
+  for (int i = 0; i < NUM_SOOT_MOMENTS; ++i) {
+    sod.typ_vals[i] =
+      typNum *
+      std::pow(m_odeTypNumC, sc.MomOrderV[i] + 2. / 3. * sc.MomOrderS[i]);
+  }
+  sod.typ_vals[NUM_SOOT_MOMENTS] = typNum;
+  // Exchanged energy, using an enthalpy scale of 1e11 erg/g for the soot mass
+  sod.typ_vals[NUM_SOOT_MOMENTS + 1] =
+    sod.typ_vals[1] * sc.SootMolarMass * 1.E11;
+  for (int i = 0; i < NUM_SOOT_ODE; ++i) {
+    sod.abs_tol[i] = m_odeAtolFact * sod.typ_vals[i];
+  }
+  return sod;
 }
 
 // Compute time step estimate for soot
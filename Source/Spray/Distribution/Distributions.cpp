@@ -27,6 +27,15 @@ Uniform::get_avg_dia()
   return get_dia();
 }
 
+DistSampler
+Uniform::get_sampler() const
+{
+  DistSampler ds;
+  ds.type = DistSampler::uniform;
+  ds.p1 = m_diam;
+  return ds;
+}
+
 void
 Normal::init(const std::string& a_prefix)
 {
@@ -54,6 +63,16 @@ Normal::get_avg_dia()
   return m_mean;
 }
 
+DistSampler
+Normal::get_sampler() const
+{
+  DistSampler ds;
+  ds.type = DistSampler::normal;
+  ds.p1 = m_mean;
+  ds.p2 = m_std;
+  return ds;
+}
+
 void
 LogNormal::init(const amrex::Real& mean, const amrex::Real& std)
 {
@@ -85,6 +104,16 @@ LogNormal::get_avg_dia()
   return m_mean;
 }
 
+DistSampler
+LogNormal::get_sampler() const
+{
+  DistSampler ds;
+  ds.type = DistSampler::log_normal;
+  ds.p1 = m_log_mean;
+  ds.p2 = m_log_std;
+  return ds;
+}
+
 void
 Weibull::init(const std::string& a_prefix)
 {
@@ -113,6 +142,16 @@ Weibull::get_avg_dia()
   return m_mean;
 }
 
+DistSampler
+Weibull::get_sampler() const
+{
+  DistSampler ds;
+  ds.type = DistSampler::weibull;
+  ds.p1 = m_mean;
+  ds.p2 = m_k;
+  return ds;
+}
+
 void
 ChiSquared::init(const std::string& a_prefix)
 {
@@ -172,3 +211,15 @@ ChiSquared::get_avg_dia()
   }
   return curxi * dmean;
 }
+
+DistSampler
+ChiSquared::get_sampler() const
+{
+  DistSampler ds;
+  ds.type = DistSampler::chi_squared;
+  ds.p1 = m_d32;
+  for (int i = 0; i < DistSampler::num_chi_vals; ++i) {
+    ds.rvals[i] = rvals[i];
+  }
+  return ds;
+}
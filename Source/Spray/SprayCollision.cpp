@@ -0,0 +1,262 @@
+
+#include "SprayParticles.H"
+#include "SprayBinSort.H"
+#include <AMReX_DenseBins.H>
+
+using namespace amrex;
+
+// Random number for draw number draw of a parcel. The rank that created the
+// parcel is mixed into the seed since parcel ids are only unique per rank
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE Real
+parcelRandom(
+  const std::uint64_t seed, const SprayParticleRef& p, const int draw)
+{
+  const auto cpu = static_cast<std::uint64_t>(static_cast<int>(p.cpu()));
+  return jetRandom(
+    seed + 0x9E6C63D0676A9A99ULL * (cpu + 1),
+    static_cast<std::uint64_t>(p.id()), draw);
+}
+
+// Move N_c droplets of parcel po into the N_c droplets of parcel pc, which
+// coalesce pairwise. Mass, species mass, momentum and liquid sensible energy
+// are conserved. Parcel po keeps its droplet properties and is removed if it
+// has no droplets left
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
+coalesceParcels(
+  const SprayParticleRef& pc,
+  const SprayParticleRef& po,
+  const Real m_c,
+  const Real m_o,
+  const Real cp_c,
+  const Real cp_o,
+  const SprayData& fdat)
+{
+  const Real N_c = pc.rdata(SprayComps::pstateNumDens);
+  const Real N_o = po.rdata(SprayComps::pstateNumDens);
+  const Real m_new = m_c + m_o;
+  const Real w_c = m_c / m_new;
+  const Real w_o = m_o / m_new;
+  for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+    pc.rdata(SprayComps::pstateVel + dir) =
+      w_c * pc.rdata(SprayComps::pstateVel + dir) +
+      w_o * po.rdata(SprayComps::pstateVel + dir);
+  }
+  const Real T_new = (m_c * cp_c * pc.rdata(SprayComps::pstateT) +
+                      m_o * cp_o * po.rdata(SprayComps::pstateT)) /
+                     (m_c * cp_c + m_o * cp_o);
+  Real rho_new = 0.;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    const Real Y_new = w_c * pc.rdata(SprayComps::pstateY + spf) +
+                       w_o * po.rdata(SprayComps::pstateY + spf);
+    pc.rdata(SprayComps::pstateY + spf) = Y_new;
+    rho_new += Y_new / fdat.rhoL(T_new, spf);
+  }
+  rho_new = 1. / rho_new;
+  pc.rdata(SprayComps::pstateT) = T_new;
+  pc.rdata(SprayComps::pstateDia) = std::cbrt(6. * m_new / (M_PI * rho_new));
+  const Real N_left = N_o - N_c;
+  if (N_left <= 1.E-12 * N_o) {
+    po.id() = -1;
+  } else {
+    po.rdata(SprayComps::pstateNumDens) = N_left;
+    po.rdata(SprayComps::pstateN0) *= N_left / N_o;
+  }
+}
+
+// Collide the droplets of a pair of parcels in the same cell with the model
+// of O'Rourke. The parcel with fewer droplets is the collector and each of
+// its droplets collides at most once with a droplet of the other parcel.
+// nbar_fact scales the expected number of collisions to account for the
+// other parcels in the cell. Returns 0 for no collision, 1 for grazing and 2
+// for coalescence
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE int
+collideParcelPair(
+  const SprayParticleRef& pa,
+  const SprayParticleRef& pb,
+  const SprayData& fdat,
+  const Real dt_inv_vol,
+  const Real nbar_fact,
+  const Real cutoff,
+  const Real rand1,
+  const Real rand2)
+{
+  const bool a_coll = (pa.rdata(SprayComps::pstateNumDens) <=
+                       pb.rdata(SprayComps::pstateNumDens));
+  const SprayParticleRef& pc = a_coll ? pa : pb;
+  const SprayParticleRef& po = a_coll ? pb : pa;
+  const Real N_c = pc.rdata(SprayComps::pstateNumDens);
+  const Real N_o = po.rdata(SprayComps::pstateNumDens);
+  Real du2 = 0.;
+  for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+    const Real du = pc.rdata(SprayComps::pstateVel + dir) -
+                    po.rdata(SprayComps::pstateVel + dir);
+    du2 += du * du;
+  }
+  const Real du_mag = std::sqrt(du2);
+  const Real r_c = 0.5 * pc.rdata(SprayComps::pstateDia);
+  const Real r_o = 0.5 * po.rdata(SprayComps::pstateDia);
+  const Real r_sum = r_c + r_o;
+  // Expected number of collisions of each collector droplet
+  const Real nbar =
+    nbar_fact * N_o * M_PI * r_sum * r_sum * du_mag * dt_inv_vol;
+  if (nbar < cutoff || rand1 >= 1. - std::exp(-nbar)) {
+    return 0;
+  }
+  Real cp_c = 0.;
+  Real cp_o = 0.;
+  const Real m_c = parcelDropMass(pc, fdat, cp_c);
+  const Real m_o = parcelDropMass(po, fdat, cp_o);
+  // Critical impact parameter from the Weber number of the smaller droplet
+  const Real r_small = amrex::min(r_c, r_o);
+  const Real gamma = amrex::max(r_c, r_o) / r_small;
+  const Real m_small = (r_c <= r_o) ? m_c : m_o;
+  const Real rho_small = m_small / (4. / 3. * M_PI * std::pow(r_small, 3));
+  const Real We = rho_small * du2 * r_small / fdat.sigma;
+  const Real fgam = gamma * (gamma * (gamma - 2.4) + 2.7);
+  const Real b_crit =
+    r_sum * std::sqrt(amrex::min(1., 2.4 * fgam / amrex::max(We, 1.E-12)));
+  const Real b_imp = r_sum * std::sqrt(rand2);
+  if (b_imp < b_crit) {
+    coalesceParcels(pc, po, m_c, m_o, cp_c, cp_o, fdat);
+    return 2;
+  }
+  // Grazing collision, the collector droplets and the droplets of the other
+  // parcel they collided with exchange momentum
+  const Real s_fact = (b_imp - b_crit) / (r_sum - b_crit);
+  const Real inv_m = 1. / (m_c + m_o);
+  const Real f_o = N_c / N_o;
+  for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+    const Real u_c = pc.rdata(SprayComps::pstateVel + dir);
+    const Real u_o = po.rdata(SprayComps::pstateVel + dir);
+    const Real mom = m_c * u_c + m_o * u_o;
+    pc.rdata(SprayComps::pstateVel + dir) =
+      (mom + m_o * (u_c - u_o) * s_fact) * inv_m;
+    const Real u_o_new = (mom + m_c * (u_o - u_c) * s_fact) * inv_m;
+    po.rdata(SprayComps::pstateVel + dir) = f_o * u_o_new + (1. - f_o) * u_o;
+  }
+  return 1;
+}
+
+void
+SprayParticleContainer::collideParcels(
+  const int level, const Real flow_dt, const int nstep)
+{
+  if (!m_doCollision || level >= this->GetParticles().size()) {
+    return;
+  }
+  BL_PROFILE("SprayParticleContainer::collideParcels()");
+  const auto dxiarr = this->Geom(level).InvCellSizeArray();
+  const auto ploarr = this->Geom(level).ProbLoArray();
+  const RealVect dxi(AMREX_D_DECL(dxiarr[0], dxiarr[1], dxiarr[2]));
+  const RealVect plo(AMREX_D_DECL(ploarr[0], ploarr[1], ploarr[2]));
+  const Real dt_inv_vol = flow_dt * AMREX_D_TERM(dxi[0], *dxi[1], *dxi[2]);
+  const Real cutoff = m_collCutoff;
+  // The random numbers of a parcel only depend on the seed, the step, the
+  // parcel id and the rank that created the parcel, so the collisions do not
+  // depend on the order of the parcels in their tile or on the tiling. Since
+  // parcels created by breakup, splashing or injection take their id and
+  // creating rank from the rank that owns them at that time, the collisions
+  // still depend on the number of ranks
+  const auto seed = static_cast<std::uint64_t>(m_collSeed) +
+                    0xD1B54A32D192ED03ULL * static_cast<std::uint64_t>(nstep);
+  const Real strt_time = ParallelDescriptor::second();
+  // Number of parcels, grazing collisions and coalescences
+  Long num_parts = 0;
+  Long num_grazing = 0;
+  Long num_coalesce = 0;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())                             \
+  reduction(+ : num_parts, num_grazing, num_coalesce)
+#endif
+  {
+    for (MyParIter pti(*this, level); pti.isValid(); ++pti) {
+      const int Np = pti.numParticles();
+      num_parts += Np;
+      if (Np < 2) {
+        continue;
+      }
+      const Box tile_box = pti.tilebox();
+      const int trash_bin = static_cast<int>(tile_box.numPts());
+      const auto ptd = pti.GetParticleTile().getParticleTileData();
+      const SprayData* fdat = d_sprayData;
+      // Bin the parcels by cell, wall film parcels do not collide
+      Gpu::DeviceVector<int> part_cell(Np);
+      int* pcell = part_cell.data();
+      amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+        const SprayParticleRef p(ptd, pid);
+        const IntVect ijkc = ((p.pos() - plo) * dxi).floor();
+        const bool can_collide =
+          (p.id() > 0 && p.rdata(SprayComps::pstateFilmHght) == 0. &&
+           tile_box.contains(ijkc));
+        pcell[pid] =
+          can_collide ? static_cast<int>(tile_box.index(ijkc)) : trash_bin;
+      });
+      DenseBins<int> bins;
+      bins.build(
+        Np, pcell, trash_bin + 1,
+        [=] AMREX_GPU_DEVICE(const int& cell) noexcept -> unsigned int {
+          return static_cast<unsigned int>(cell);
+        });
+      const auto* offsets = bins.offsetsPtr();
+      // Shuffle the parcels of each cell by sorting them by a random number,
+      // ties are broken by the parcel key so the order does not depend on
+      // the binning order
+      DenseBins<int> sorted_bins;
+      sortBinsByKey(
+        Np, trash_bin, pcell, offsets,
+        [=] AMREX_GPU_DEVICE(int pid) noexcept -> Real {
+          return parcelRandom(seed, SprayParticleRef(ptd, pid), 0);
+        },
+        [=] AMREX_GPU_DEVICE(int pid) noexcept -> std::uint64_t {
+          return parcelKey(SprayParticleRef(ptd, pid));
+        },
+        sorted_bins);
+      const auto* perm = sorted_bins.permutationPtr();
+      Gpu::DeviceVector<int> counts_d(2, 0);
+      int* counts = counts_d.data();
+      // Collide consecutive shuffled parcels of each cell in pairs. Each
+      // parcel is paired with one of the nbin - 1 other parcels, so the
+      // expected number of collisions is scaled accordingly
+      amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int e) noexcept {
+        const auto ia = static_cast<int>(perm[e]);
+        const int bin = pcell[ia];
+        if (bin == trash_bin) {
+          return;
+        }
+        const auto start = static_cast<int>(offsets[bin]);
+        const int nbin = static_cast<int>(offsets[bin + 1]) - start;
+        const int loc = e - start;
+        if (loc % 2 != 0 || loc + 1 >= nbin) {
+          return;
+        }
+        const SprayParticleRef pa(ptd, ia);
+        const SprayParticleRef pb(ptd, static_cast<int>(perm[e + 1]));
+        const int outcome = collideParcelPair(
+          pa, pb, *fdat, dt_inv_vol, static_cast<Real>(nbin - 1), cutoff,
+          parcelRandom(seed, pa, 1), parcelRandom(seed, pa, 2));
+        if (outcome > 0) {
+          Gpu::Atomic::AddNoRet(&counts[outcome - 1], 1);
+        }
+      });
+      Vector<int> counts_h(2);
+      Gpu::copy(
+        Gpu::deviceToHost, counts_d.begin(), counts_d.end(), counts_h.begin());
+      num_grazing += counts_h[0];
+      num_coalesce += counts_h[1];
+    }
+  }
+  if (m_verbose > 0) {
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    Real run_time = ParallelDescriptor::second() - strt_time;
+    ParallelDescriptor::ReduceRealMax(run_time, IOProc);
+    ParallelDescriptor::ReduceLongSum(num_parts, IOProc);
+    ParallelDescriptor::ReduceLongSum(num_grazing, IOProc);
+    ParallelDescriptor::ReduceLongSum(num_coalesce, IOProc);
+    Print() << "SprayParticleContainer::collideParcels() on level " << level
+            << ": " << num_grazing << " grazing collisions and "
+            << num_coalesce << " coalescences of " << num_parts
+            << " parcels in " << run_time << " s ("
+            << run_time / static_cast<Real>(amrex::max(num_parts, Long(1)))
+            << " s per parcel)" << std::endl;
+  }
+}
@@ -1,5 +1,6 @@
 
 #include "SprayParticles.H"
+#include <iomanip>
 
 using namespace amrex;
 
@@ -7,7 +8,7 @@ void
 SprayParticleContainer::SprayParticleIO(
   const int level, const bool is_checkpoint, const std::string& dir)
 {
-  Vector<std::string> real_comp_names(NSR_SPR);
+  Vector<std::string> real_comp_names(NAR_SPR);
   AMREX_D_TERM(real_comp_names[SprayComps::pstateVel] = "xvel";
                , real_comp_names[SprayComps::pstateVel + 1] = "yvel";
                , real_comp_names[SprayComps::pstateVel + 2] = "zvel";);
@@ -158,3 +159,133 @@ SprayParticleContainer::PostInitRestart(const std::string& dir)
   }
   Gpu::streamSynchronize();
 }
+
+// Open a statistics file for appending, the header is written if the file
+// does not exist yet
+void
+openStatsFile(
+  std::ofstream& file, const std::string& fname, const std::string& header)
+{
+  const bool is_new = !FileSystem::Exists(fname);
+  file.open(fname.c_str(), std::ios::out | std::ios::app);
+  if (!file.good()) {
+    FileOpenFailed(fname);
+  }
+  if (is_new) {
+    file << header << "\n";
+  }
+  file << std::setprecision(10);
+}
+
+void
+SprayParticleContainer::writeSprayStats(const int nstep, const Real time)
+{
+  if (m_statsInt <= 0 || nstep % m_statsInt != 0) {
+    return;
+  }
+  BL_PROFILE("SprayParticleContainer::writeSprayStats()");
+  const SprayStatsData stats = m_statsData;
+  Real* accum = m_statsAccumD;
+  // Sample the diameter moments and histograms from the active parcels,
+  // wall film parcels are not included
+  const int num_levs =
+    amrex::min(finestLevel() + 1, static_cast<int>(GetParticles().size()));
+  for (int lev = 0; lev < num_levs; ++lev) {
+    for (MyParIter pti(*this, lev); pti.isValid(); ++pti) {
+      const int Np = pti.numParticles();
+      const auto ptd = pti.GetParticleTile().getParticleTileData();
+      amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+        const SprayParticleRef p(ptd, pid);
+        if (p.id() > 0 && p.rdata(SprayComps::pstateFilmHght) == 0.) {
+          const RealVect vel(AMREX_D_DECL(
+            p.rdata(SprayComps::pstateVel), p.rdata(SprayComps::pstateVel + 1),
+            p.rdata(SprayComps::pstateVel + 2)));
+          stats.addParcel(
+            accum, p.pos(), vel, p.rdata(SprayComps::pstateDia),
+            p.rdata(SprayComps::pstateNumDens));
+        }
+      });
+    }
+  }
+  const int nvals = stats.num_vals;
+  Vector<Real> vals(nvals);
+  Gpu::copy(Gpu::deviceToHost, accum, accum + nvals, vals.begin());
+  amrex::ParallelFor(
+    nvals, [=] AMREX_GPU_DEVICE(int n) noexcept { accum[n] = 0.; });
+  Gpu::streamSynchronize();
+  const Real acc_time = m_statsTime;
+  m_statsTime = 0.;
+  const int IOProc = ParallelDescriptor::IOProcessorNumber();
+  ParallelDescriptor::ReduceRealSum(vals.data(), nvals, IOProc);
+  if (!ParallelDescriptor::IOProcessor()) {
+    return;
+  }
+  const Real inv_time = (acc_time > 0.) ? 1. / acc_time : 0.;
+  auto mean_dia = [](const Real* moms, const int n) {
+    return (moms[n - 1] > 0.) ? moms[n] / moms[n - 1] : 0.;
+  };
+  const int nm = SprayStatsData::num_moms;
+  // Summary: droplet count, mean diameters, plane mass flow rates, and mean
+  // diameters and evaporation rate of each region
+  {
+    std::string header = "step,time,acc_time,num_drops,D10,D32";
+    for (int pl = 0; pl < stats.num_planes; ++pl) {
+      header += ",mdot_plane" + std::to_string(pl);
+    }
+    for (int reg = 0; reg < stats.num_regions; ++reg) {
+      const std::string rs = std::to_string(reg);
+      header += ",D10_reg" + rs + ",D32_reg" + rs + ",evap_reg" + rs;
+    }
+    std::ofstream file;
+    openStatsFile(file, m_statsFile + "_summary.csv", header);
+    file << nstep << "," << time << "," << acc_time << "," << vals[0] << ","
+         << mean_dia(vals.data(), 1) << "," << mean_dia(vals.data(), 3);
+    for (int pl = 0; pl < stats.num_planes; ++pl) {
+      file << "," << vals[stats.flux_off + pl] * inv_time;
+    }
+    for (int reg = 0; reg < stats.num_regions; ++reg) {
+      const Real* rv = vals.data() + stats.reg_off + (nm + 1) * reg;
+      file << "," << mean_dia(rv, 1) << "," << mean_dia(rv, 3) << ","
+           << rv[nm] * inv_time;
+    }
+    file << "\n";
+  }
+  // Number and volume weighted diameter PDFs
+  const Real ddia = stats.dia_max / static_cast<Real>(stats.num_dia_bins);
+  {
+    std::ofstream file;
+    openStatsFile(
+      file, m_statsFile + "_dia_pdf.csv",
+      "step,time,dia_lo,dia_hi,number_pdf,volume_pdf");
+    const Real num_fact = (vals[0] > 0.) ? 1. / (vals[0] * ddia) : 0.;
+    const Real vol_fact = (vals[3] > 0.) ? 1. / (vals[3] * ddia) : 0.;
+    for (int db = 0; db < stats.num_dia_bins; ++db) {
+      file << nstep << "," << time << "," << db * ddia << ","
+           << (db + 1) * ddia << "," << vals[stats.dia_off + db] * num_fact
+           << ","
+           << vals[stats.dia_off + stats.num_dia_bins + db] * vol_fact
+           << "\n";
+    }
+  }
+  // Joint velocity-diameter histogram, only non-empty bins are written
+  {
+    const Real vlo = stats.velBinLo();
+    const Real dvel =
+      (stats.vel_max - vlo) / static_cast<Real>(stats.num_vel_bins);
+    std::ofstream file;
+    openStatsFile(
+      file, m_statsFile + "_vel_dia.csv",
+      "step,time,dia_lo,dia_hi,vel_lo,vel_hi,num_drops");
+    for (int db = 0; db < stats.num_dia_bins; ++db) {
+      for (int vb = 0; vb < stats.num_vel_bins; ++vb) {
+        const Real cnt =
+          vals[stats.joint_off + db * stats.num_vel_bins + vb];
+        if (cnt > 0.) {
+          file << nstep << "," << time << "," << db * ddia << ","
+               << (db + 1) * ddia << "," << vlo + vb * dvel << ","
+               << vlo + (vb + 1) * dvel << "," << cnt << "\n";
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,206 @@
+
+#include "SprayParticles.H"
+#include "SprayBinSort.H"
+#include <AMReX_DenseBins.H>
+
+using namespace amrex;
+
+// Check if two parcels have a similar diameter, velocity and temperature
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE bool
+similarParcels(
+  const SprayParticleRef& pa,
+  const SprayParticleRef& pb,
+  const Real dia_tol,
+  const Real vel_tol,
+  const Real temp_tol)
+{
+  const Real dia_a = pa.rdata(SprayComps::pstateDia);
+  const Real dia_b = pb.rdata(SprayComps::pstateDia);
+  if (std::abs(dia_a - dia_b) > dia_tol * amrex::max(dia_a, dia_b)) {
+    return false;
+  }
+  const Real T_a = pa.rdata(SprayComps::pstateT);
+  const Real T_b = pb.rdata(SprayComps::pstateT);
+  if (std::abs(T_a - T_b) > temp_tol) {
+    return false;
+  }
+  Real vmag_a = 0.;
+  Real vmag_b = 0.;
+  Real dvmag = 0.;
+  for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+    const Real vel_a = pa.rdata(SprayComps::pstateVel + dir);
+    const Real vel_b = pb.rdata(SprayComps::pstateVel + dir);
+    vmag_a += vel_a * vel_a;
+    vmag_b += vel_b * vel_b;
+    dvmag += (vel_a - vel_b) * (vel_a - vel_b);
+  }
+  return (dvmag <= vel_tol * vel_tol * amrex::max(vmag_a, vmag_b));
+}
+
+// Merge parcel pb into parcel pa. The number of droplets, liquid mass, species
+// mass, momentum and liquid sensible energy are conserved and the position is
+// mass weighted. TAB variables are mass weighted, the KH-RT shed mass is added
+// and the smaller RT time is kept
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
+mergeParcelPair(
+  const SprayParticleRef& pa, const SprayParticleRef& pb, const SprayData& fdat)
+{
+  Real cp_a = 0.;
+  Real cp_b = 0.;
+  const Real N_a = pa.rdata(SprayComps::pstateNumDens);
+  const Real N_b = pb.rdata(SprayComps::pstateNumDens);
+  const Real M_a = N_a * parcelDropMass(pa, fdat, cp_a);
+  const Real M_b = N_b * parcelDropMass(pb, fdat, cp_b);
+  const Real M_tot = M_a + M_b;
+  const Real w_a = M_a / M_tot;
+  const Real w_b = M_b / M_tot;
+  for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+    pa.pos(dir) = w_a * pa.pos(dir) + w_b * pb.pos(dir);
+    pa.rdata(SprayComps::pstateVel + dir) =
+      w_a * pa.rdata(SprayComps::pstateVel + dir) +
+      w_b * pb.rdata(SprayComps::pstateVel + dir);
+  }
+  const Real T_new = (M_a * cp_a * pa.rdata(SprayComps::pstateT) +
+                      M_b * cp_b * pb.rdata(SprayComps::pstateT)) /
+                     (M_a * cp_a + M_b * cp_b);
+  Real rho_new = 0.;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    const Real Y_new = w_a * pa.rdata(SprayComps::pstateY + spf) +
+                       w_b * pb.rdata(SprayComps::pstateY + spf);
+    pa.rdata(SprayComps::pstateY + spf) = Y_new;
+    rho_new += Y_new / fdat.rhoL(T_new, spf);
+  }
+  rho_new = 1. / rho_new;
+  const Real N_new = N_a + N_b;
+  pa.rdata(SprayComps::pstateT) = T_new;
+  pa.rdata(SprayComps::pstateNumDens) = N_new;
+  pa.rdata(SprayComps::pstateN0) += pb.rdata(SprayComps::pstateN0);
+  pa.rdata(SprayComps::pstateDia) =
+    std::cbrt(6. * M_tot / (M_PI * rho_new * N_new));
+  if (fdat.do_breakup == 2) {
+    pa.rdata(SprayComps::pstateBM1) += pb.rdata(SprayComps::pstateBM1);
+    pa.rdata(SprayComps::pstateBM2) = amrex::min(
+      pa.rdata(SprayComps::pstateBM2), pb.rdata(SprayComps::pstateBM2));
+  } else {
+    pa.rdata(SprayComps::pstateBM1) = w_a * pa.rdata(SprayComps::pstateBM1) +
+                                      w_b * pb.rdata(SprayComps::pstateBM1);
+    pa.rdata(SprayComps::pstateBM2) = w_a * pa.rdata(SprayComps::pstateBM2) +
+                                      w_b * pb.rdata(SprayComps::pstateBM2);
+  }
+  pb.id() = -1;
+}
+
+void
+SprayParticleContainer::mergeParcels(const int level, const int nstep)
+{
+  if (
+    m_mergeInt <= 0 || nstep % m_mergeInt != 0 ||
+    level >= this->GetParticles().size()) {
+    return;
+  }
+  BL_PROFILE("SprayParticleContainer::mergeParcels()");
+  const auto dxiarr = this->Geom(level).InvCellSizeArray();
+  const auto ploarr = this->Geom(level).ProbLoArray();
+  const RealVect dxi(AMREX_D_DECL(dxiarr[0], dxiarr[1], dxiarr[2]));
+  const RealVect plo(AMREX_D_DECL(ploarr[0], ploarr[1], ploarr[2]));
+  const int max_ppc = m_mergeMaxPPC;
+  const Real dia_tol = m_mergeDiaTol;
+  const Real vel_tol = m_mergeVelTol;
+  const Real temp_tol = m_mergeTempTol;
+  // Number of parcels, cells above max_ppc and merged parcels
+  Long num_parts = 0;
+  Long num_full_cells = 0;
+  Long num_merged = 0;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())                             \
+  reduction(+ : num_parts, num_full_cells, num_merged)
+#endif
+  {
+    for (MyParIter pti(*this, level); pti.isValid(); ++pti) {
+      const int Np = pti.numParticles();
+      num_parts += Np;
+      if (Np <= max_ppc) {
+        continue;
+      }
+      const Box tile_box = pti.tilebox();
+      const int trash_bin = static_cast<int>(tile_box.numPts());
+      const auto ptd = pti.GetParticleTile().getParticleTileData();
+      const SprayData* fdat = d_sprayData;
+      // Bin the parcels by cell, wall film parcels are never merged
+      Gpu::DeviceVector<int> part_cell(Np);
+      int* pcell = part_cell.data();
+      amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+        const SprayParticleRef p(ptd, pid);
+        const IntVect ijkc = ((p.pos() - plo) * dxi).floor();
+        const bool can_merge =
+          (p.id() > 0 && p.rdata(SprayComps::pstateFilmHght) == 0. &&
+           tile_box.contains(ijkc));
+        pcell[pid] =
+          can_merge ? static_cast<int>(tile_box.index(ijkc)) : trash_bin;
+      });
+      DenseBins<int> bins;
+      bins.build(
+        Np, pcell, trash_bin + 1,
+        [=] AMREX_GPU_DEVICE(const int& cell) noexcept -> unsigned int {
+          return static_cast<unsigned int>(cell);
+        });
+      const auto* offsets = bins.offsetsPtr();
+      // Sort the parcels in each cell by diameter, then by parcel key so the
+      // order does not depend on the binning order
+      DenseBins<int> sorted_bins;
+      sortBinsByKey(
+        Np, trash_bin, pcell, offsets,
+        [=] AMREX_GPU_DEVICE(int pid) noexcept -> Real {
+          return SprayParticleRef(ptd, pid).rdata(SprayComps::pstateDia);
+        },
+        [=] AMREX_GPU_DEVICE(int pid) noexcept -> std::uint64_t {
+          return parcelKey(SprayParticleRef(ptd, pid));
+        },
+        sorted_bins);
+      const auto* perm = sorted_bins.permutationPtr();
+      Gpu::DeviceVector<int> counts_d(2, 0);
+      int* counts = counts_d.data();
+      amrex::ParallelFor(trash_bin, [=] AMREX_GPU_DEVICE(int bin) noexcept {
+        const auto start = offsets[bin];
+        const int nbin = static_cast<int>(offsets[bin + 1] - start);
+        if (nbin <= max_ppc) {
+          return;
+        }
+        Gpu::Atomic::AddNoRet(&counts[0], 1);
+        const auto* seg = perm + start;
+        // Merge neighbouring parcels into a representative parcel while they
+        // are similar to it and the cell has too many parcels
+        int excess = nbin - max_ppc;
+        int merged = 0;
+        int rep = static_cast<int>(seg[0]);
+        for (int i = 1; i < nbin && excess > 0; ++i) {
+          const SprayParticleRef pa(ptd, rep);
+          const SprayParticleRef pb(ptd, static_cast<int>(seg[i]));
+          if (similarParcels(pa, pb, dia_tol, vel_tol, temp_tol)) {
+            mergeParcelPair(pa, pb, *fdat);
+            --excess;
+            ++merged;
+          } else {
+            rep = static_cast<int>(seg[i]);
+          }
+        }
+        Gpu::Atomic::AddNoRet(&counts[1], merged);
+      });
+      Vector<int> counts_h(2);
+      Gpu::copy(
+        Gpu::deviceToHost, counts_d.begin(), counts_d.end(), counts_h.begin());
+      num_full_cells += counts_h[0];
+      num_merged += counts_h[1];
+    }
+  }
+  if (m_verbose > 0) {
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceLongSum(num_parts, IOProc);
+    ParallelDescriptor::ReduceLongSum(num_full_cells, IOProc);
+    ParallelDescriptor::ReduceLongSum(num_merged, IOProc);
+    Print() << "SprayParticleContainer::mergeParcels() on level " << level
+            << ": merged " << num_merged << " of " << num_parts
+            << " parcels in " << num_full_cells << " cells with more than "
+            << max_ppc << " parcels" << std::endl;
+  }
+}
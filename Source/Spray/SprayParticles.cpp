@@ -7,12 +7,18 @@
 #include "TABBreakup.H"
 #include "ReitzKHRT.H"
 #include "WallFilm.H"
+#include "SprayBinSort.H"
+#include <AMReX_DenseBins.H>
 #ifdef AMREX_USE_EB
 #include <AMReX_EBFArrayBox.H>
 #endif
 
 using namespace amrex;
 
+// Number of source components deposited per parcel and subcycle: momentum,
+// mass, fuel mass fractions and energy
+constexpr int SPRAY_DEP_NUM = AMREX_SPACEDIM + 2 + SPRAY_FUEL_NUM;
+
 void
 SprayParticleContainer::init_bcs()
 {
@@ -108,12 +114,11 @@ SprayParticleContainer::estTimestep(int level) const
 #endif
     {
       for (MyParConstIter pti(*this, level); pti.isValid(); ++pti) {
-        const AoS& pbox = pti.GetArrayOfStructs();
-        const ParticleType* pstruct = pbox().data();
-        const int n = pbox.numParticles();
+        const auto ptd = pti.GetParticleTile().getConstParticleTileData();
+        const int n = pti.numParticles();
         reduce_op.eval(
           n, reduce_data, [=] AMREX_GPU_DEVICE(const int i) -> ReduceTuple {
-            const ParticleType& p = pstruct[i];
+            const SprayParticleConstRef p(ptd, i);
             if (p.id() > 0) {
               const Real max_mag_vdx = amrex::max(AMREX_D_DECL(
                 std::abs(p.rdata(SprayComps::pstateVel)) * dxi[0],
@@ -141,6 +146,184 @@ SprayParticleContainer::estTimestep(int level) const
   return dt;
 }
 
+// Atomically add one set of parcel source contributions to cell iv
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
+addDepVals(
+  const IntVect& iv,
+  const Real* dv,
+  const bool mom_trans,
+  const bool mass_trans,
+  Array4<Real> const& momSrcarr,
+  Array4<Real> const& rhoSrcarr,
+  Array4<Real> const& rhoYSrcarr,
+  Array4<Real> const& engSrcarr)
+{
+  if (mom_trans) {
+    for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+      Gpu::Atomic::AddNoRet(&momSrcarr(iv, dir), dv[dir]);
+    }
+  }
+  if (mass_trans) {
+    Gpu::Atomic::AddNoRet(&rhoSrcarr(iv), dv[AMREX_SPACEDIM]);
+    for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+      Gpu::Atomic::AddNoRet(&rhoYSrcarr(iv, spf), dv[AMREX_SPACEDIM + 1 + spf]);
+    }
+  }
+  Gpu::Atomic::AddNoRet(&engSrcarr(iv), dv[SPRAY_DEP_NUM - 1]);
+}
+
+// Add the source contributions recorded for each run of subcycles a parcel
+// spends in one cell to the gas phase source arrays without floating point
+// atomics. The contributions are binned by cell and sorted within each bin
+// by run index and parcel key, so the order does not depend on the order of
+// the parcels or of the overflow slots. Each cell then sums its own bin
+// starting from the current source value. If the tile does not cover its
+// grid, the parcels of other tiles may deposit to any cell of dep_box and
+// all cells are updated atomically
+void
+depositSortedSources(
+  const Box& dep_box,
+  const bool exclusive,
+  const Long num_dep,
+  const int* dep_cell,
+  const int* dep_run,
+  const std::uint64_t* dep_tie,
+  const Real* dep_vals,
+  const bool mom_trans,
+  const bool mass_trans,
+  Array4<Real> const& momSrcarr,
+  Array4<Real> const& rhoSrcarr,
+  Array4<Real> const& rhoYSrcarr,
+  Array4<Real> const& engSrcarr)
+{
+  BL_PROFILE("SprayParticleContainer::depositSortedSources()");
+  const int nbins = static_cast<int>(dep_box.numPts());
+  // Contributions outside of dep_box are put in the last bin and ignored
+  DenseBins<int> bins;
+  bins.build(
+    num_dep, dep_cell, nbins + 1,
+    [=] AMREX_GPU_DEVICE(const int& cell) noexcept -> unsigned int {
+      return static_cast<unsigned int>(cell);
+    });
+  DenseBins<int> sorted;
+  sortBinsByKey(
+    static_cast<int>(num_dep), nbins, dep_cell, bins.offsetsPtr(),
+    [=] AMREX_GPU_DEVICE(const int e) noexcept -> Real {
+      return static_cast<Real>(dep_run[e]);
+    },
+    [=] AMREX_GPU_DEVICE(const int e) noexcept -> std::uint64_t {
+      return dep_tie[e];
+    },
+    sorted);
+  // The sorted bins keep the offsets of the bins by cell
+  const auto* perm = sorted.permutationPtr();
+  const auto* offsets = bins.offsetsPtr();
+  amrex::ParallelFor(
+    dep_box, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      const IntVect iv(AMREX_D_DECL(i, j, k));
+      const auto bin = static_cast<int>(dep_box.index(iv));
+      const auto start = offsets[bin];
+      const auto stop = offsets[bin + 1];
+      if (start == stop) {
+        return;
+      }
+      auto bin_sum = [=](const int comp, Real& dst) {
+        Real sum = exclusive ? dst : 0.;
+        for (auto e = start; e < stop; ++e) {
+          sum += dep_vals[static_cast<Long>(perm[e]) * SPRAY_DEP_NUM + comp];
+        }
+        if (exclusive) {
+          dst = sum;
+        } else {
+          Gpu::Atomic::AddNoRet(&dst, sum);
+        }
+      };
+      if (mom_trans) {
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          bin_sum(dir, momSrcarr(iv, dir));
+        }
+      }
+      if (mass_trans) {
+        bin_sum(AMREX_SPACEDIM, rhoSrcarr(iv));
+        for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+          bin_sum(AMREX_SPACEDIM + 1 + spf, rhoYSrcarr(iv, spf));
+        }
+      }
+      bin_sum(SPRAY_DEP_NUM - 1, engSrcarr(iv));
+    });
+  Gpu::streamSynchronize();
+}
+
+#ifdef AMREX_USE_EB
+void
+SprayParticleContainer::buildEBStencilCache(
+  const int level, const MultiFab& state)
+{
+  if (static_cast<int>(m_ebStencil.size()) <= level) {
+    m_ebStencil.resize(level + 1);
+    m_ebStencilData.resize(level + 1);
+  }
+  const int ng = state.nGrow();
+  // The stencils only depend on the EB geometry, so they are reused until
+  // the grids change
+  if (
+    m_ebStencil[level] != nullptr &&
+    m_ebStencil[level]->boxArray() == state.boxArray() &&
+    m_ebStencil[level]->DistributionMap() == state.DistributionMap() &&
+    m_ebStencil[level]->nGrow() == ng) {
+    return;
+  }
+  BL_PROFILE("SprayParticleContainer::buildEBStencilCache()");
+  m_ebStencil[level] = std::make_unique<iMultiFab>(
+    state.boxArray(), state.DistributionMap(), 1, ng);
+  m_ebStencilData[level] = std::make_unique<MultiFab>(
+    state.boxArray(), state.DistributionMap(), AMREX_SPACEDIM + 1, ng);
+  const auto& factory =
+    dynamic_cast<EBFArrayBoxFactory const&>(state.Factory());
+  const auto* cellcent = &(factory.getCentroid());
+  const auto* bndrycent = &(factory.getBndryCent());
+  const auto* bndrynorm = &(factory.getBndryNormal());
+  const auto* volfrac = &(factory.getVolFrac());
+  const Real min_eb_vfrac = m_sprayData->min_eb_vfrac;
+  Long num_cut = 0;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion()) reduction(+ : num_cut)
+#endif
+  for (MFIter mfi(*m_ebStencil[level]); mfi.isValid(); ++mfi) {
+    const Box bx = mfi.fabbox();
+    Array4<int> const& stencil = m_ebStencil[level]->array(mfi);
+    Array4<Real> const& ebdat = m_ebStencilData[level]->array(mfi);
+    const auto& interp_fab = static_cast<EBFArrayBox const&>(state[mfi]);
+    const EBCellFlagFab& flags = interp_fab.getEBCellFlagFab();
+    if (flags.getType(bx) == FabType::regular) {
+      // Never used since eb_interp is not called for regular boxes
+      (*m_ebStencil[level])[mfi].setVal<RunOn::Device>(0);
+      (*m_ebStencilData[level])[mfi].setVal<RunOn::Device>(0.);
+      continue;
+    }
+    const auto& flags_array = flags.array();
+    const Box fbox = flags.box();
+    Array4<const Real> const& ccent_fab = cellcent->array(mfi);
+    Array4<const Real> const& bcent_fab = bndrycent->array(mfi);
+    Array4<const Real> const& bnorm_fab = bndrynorm->array(mfi);
+    Array4<const Real> const& volfrac_fab = volfrac->array(mfi);
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      fillEBStencil(
+        IntVect(AMREX_D_DECL(i, j, k)), fbox, flags_array, ccent_fab,
+        bcent_fab, bnorm_fab, volfrac_fab, min_eb_vfrac, stencil, ebdat);
+    });
+    num_cut += 1;
+  }
+  if (m_verbose > 1) {
+    ParallelDescriptor::ReduceLongSum(
+      num_cut, ParallelDescriptor::IOProcessorNumber());
+    Print() << "SprayParticleContainer::buildEBStencilCache() on level "
+            << level << ": " << num_cut << " boxes with EB stencils"
+            << std::endl;
+  }
+}
+#endif
+
 void
 SprayParticleContainer::updateParticles(
   const int& level,
@@ -198,6 +381,9 @@ SprayParticleContainer::updateParticles(
   const auto* bndrycent = &(factory.getBndryCent());
   const auto* bndrynorm = &(factory.getBndryNormal());
   const auto* volfrac = &(factory.getVolFrac());
+  buildEBStencilCache(level, state);
+  const iMultiFab& eb_stencil = *m_ebStencil[level];
+  const MultiFab& eb_stencil_data = *m_ebStencilData[level];
 #endif
   IntVect bndry_lo; // Designation for boundary types
   IntVect bndry_hi; // 0 - Periodic, 1 - Reflective, -1 - Non-reflective
@@ -241,10 +427,30 @@ SprayParticleContainer::updateParticles(
   }
   // Particle components indices
   SprayComps SPI = m_sprayIndx;
+  const bool sort_depos = sorted_deposition;
+  // With adaptive subcycling, num_iter is the maximum number of subcycles and
+  // each parcel picks its own count
+  const bool adapt_sub = (adaptive_subcycling && num_iter > 1);
+  // Number of parcels that took n subcycles, for n = 1, ..., num_iter
+  Vector<Long> sub_hist(num_iter + 1, 0);
+  // In-situ statistics of the liquid mass crossing planes and evaporating in
+  // regions are only accumulated when the active parcels move
+  const bool do_stats = (m_statsInt > 0 && isActive && do_move);
+  const SprayStatsData stats = m_statsData;
+  Real* stats_accum = m_statsAccumD;
+  if (do_stats && level == 0) {
+    m_statsTime += flow_dt;
+  }
+  // Number of parcel updates (parcels times subcycles) for timing
+  const Real strt_time = ParallelDescriptor::second();
+  Long num_updates = 0;
+  // Liquid mass of the splash and breakup parcels created outside the domain
+  Real lost_sb_mass = 0.;
   // Start the ParIter, which loops over separate sets of particles in different
   // boxes
 #ifdef AMREX_USE_OMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
+#pragma omp parallel if (Gpu::notInLaunchRegion())                             \
+  reduction(+ : num_updates, lost_sb_mass)
 #endif
   {
     for (MyParIter pti(*this, level); pti.isValid(); ++pti) {
@@ -256,8 +462,15 @@ SprayParticleContainer::updateParticles(
       if (Np == 0) {
         continue;
       }
-      AoS& pbox = pti.GetArrayOfStructs();
-      ParticleType* pstruct = pbox().data();
+      const auto ptd = pti.GetParticleTile().getParticleTileData();
+      Gpu::DeviceVector<int> sub_hist_d;
+      int* sub_hist_ptr = nullptr;
+      if (adapt_sub) {
+        sub_hist_d.resize(num_iter + 1, 0);
+        sub_hist_ptr = sub_hist_d.data();
+      } else {
+        num_updates += static_cast<Long>(Np) * num_iter;
+      }
       const SprayData* fdat = d_sprayData;
       Array4<const Real> const& Tarr = state.array(pti, SPI.utempIndx);
       Array4<const Real> const& rhoYarr = state.array(pti, SPI.specIndx);
@@ -278,6 +491,8 @@ SprayParticleContainer::updateParticles(
       Array4<const Real> bcent_fab;
       Array4<const Real> bnorm_fab;
       Array4<const Real> volfrac_fab;
+      Array4<const int> stencil_fab;
+      Array4<const Real> stencil_data_fab;
       const auto& flags_array = flags.array();
       if (flags.getType(state_box) == FabType::regular) {
         eb_in_box = false;
@@ -289,6 +504,9 @@ SprayParticleContainer::updateParticles(
         // Normal of EB
         bnorm_fab = bndrynorm->array(pti);
         volfrac_fab = volfrac->array(pti);
+        // Cached interpolation stencils
+        stencil_fab = eb_stencil.const_array(pti);
+        stencil_data_fab = eb_stencil_data.const_array(pti);
       }
 #endif
       bool do_splash_box = (do_splash && (eb_in_box || at_bounds));
@@ -301,30 +519,82 @@ SprayParticleContainer::updateParticles(
         // TODO: Adjust this for EB faces
         Real face_area = AMREX_D_TERM(dx[0], *dx[1], *dx[2]);
         amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
-          ParticleType& p = pstruct[pid];
+          const SprayParticleRef p(ptd, pid);
           if (p.id() > 0 && p.rdata(SprayComps::pstateFilmHght) > 0.) {
             fillFilmFab(wf_arr, p, face_area, plo, dx);
           }
         });
       }
       // Data structures for creating new particles during splashing/breakup
-      Gpu::HostVector<splash_breakup> N_SB_h;
       Gpu::DeviceVector<splash_breakup> N_SB_d;
       SBVects refv;
       SBPtrs rf_d;
       bool make_new_drops =
         ((do_breakup || do_splash_box) && isActive && do_move);
       if (make_new_drops) {
-        N_SB_h.assign(Np, splash_breakup::no_change);
-        N_SB_d.resize(Np);
-        Gpu::copyAsync(
-          Gpu::hostToDevice, N_SB_h.begin(), N_SB_h.end(), N_SB_d.begin());
+        N_SB_d.resize(Np, splash_breakup::no_change);
         refv.build(Np);
         refv.fillPtrs_d(rf_d);
       }
       auto* N_SB = N_SB_d.dataPtr();
-      amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
-        ParticleType& p = pstruct[pid];
+      // For sorted deposition, parcels are processed in order of their cell
+      // to improve the locality of the gas phase interpolation. The source
+      // contributions of consecutive subcycles in the same cell are summed
+      // and stored once. The first such run of each parcel is stored at its
+      // index and the following runs in an overflow region of Np records,
+      // each with its run index and parcel key to order the sums. Runs that
+      // do not fit are added atomically
+      const Box dep_box = source[pti].box();
+      const int trash_bin = static_cast<int>(dep_box.numPts());
+      const Long num_dep = 2 * static_cast<Long>(Np);
+      DenseBins<int> part_bins;
+      Gpu::DeviceVector<int> part_cell;
+      Gpu::DeviceVector<int> dep_cell_v;
+      Gpu::DeviceVector<int> dep_run_v;
+      Gpu::DeviceVector<std::uint64_t> dep_tie_v;
+      Gpu::DeviceVector<Real> dep_vals_v;
+      Gpu::DeviceVector<int> dep_extra_v;
+      const unsigned int* part_perm = nullptr;
+      int* dep_cell = nullptr;
+      int* dep_run = nullptr;
+      std::uint64_t* dep_tie = nullptr;
+      Real* dep_vals = nullptr;
+      int* dep_extra = nullptr;
+      if (sort_depos) {
+        part_cell.resize(Np);
+        dep_cell_v.resize(num_dep);
+        dep_run_v.resize(num_dep);
+        dep_tie_v.resize(num_dep);
+        dep_vals_v.resize(num_dep * SPRAY_DEP_NUM);
+        dep_extra_v.resize(1, 0);
+        int* pcell = part_cell.data();
+        dep_cell = dep_cell_v.data();
+        dep_run = dep_run_v.data();
+        dep_tie = dep_tie_v.data();
+        dep_vals = dep_vals_v.data();
+        dep_extra = dep_extra_v.data();
+        amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+          const SprayParticleRef p(ptd, pid);
+          const IntVect ijkc = ((p.pos() - plo) * dxi).floor();
+          pcell[pid] = dep_box.contains(ijkc)
+                         ? static_cast<int>(dep_box.index(ijkc))
+                         : trash_bin;
+        });
+        amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int n) noexcept {
+          dep_cell[n] = trash_bin;
+          dep_run[n] = 0;
+          dep_tie[n] = 0;
+        });
+        part_bins.build(
+          Np, pcell, trash_bin + 1,
+          [=] AMREX_GPU_DEVICE(const int& cell) noexcept -> unsigned int {
+            return static_cast<unsigned int>(cell);
+          });
+        part_perm = part_bins.permutationPtr();
+      }
+      amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int ip) noexcept {
+        const int pid = sort_depos ? static_cast<int>(part_perm[ip]) : ip;
+        const SprayParticleRef p(ptd, pid);
         if (p.id() > 0) {
           auto eos = pele::physics::PhysicsType::eos();
           SprayUnits SPU;
@@ -355,6 +625,40 @@ SprayParticleContainer::updateParticles(
           // Used for ETAB breakup model
           Real Utan_total = 0.;
           Real Reyn_d = 0.;
+          // Remaining time and inverse relaxation and evaporation times from
+          // the last subcycle, used for adaptive subcycling
+          Real t_rem = flow_dt;
+          Real inv_tau_mom = -1.;
+          Real inv_tau_evap = 0.;
+          int num_sub = 0;
+          // Cell and summed contributions of the current run of subcycles
+          // for sorted deposition
+          int run_cell = trash_bin;
+          GpuArray<Real, SPRAY_DEP_NUM> run_vals{};
+          int run_idx = 0;
+          const std::uint64_t pkey = parcelKey(p);
+          auto store_run = [&]() {
+            if (run_cell == trash_bin) {
+              return;
+            }
+            Long de = pid;
+            if (run_idx > 0) {
+              de = Np + static_cast<Long>(Gpu::Atomic::Add(dep_extra, 1));
+            }
+            if (de < num_dep) {
+              dep_cell[de] = run_cell;
+              dep_run[de] = run_idx;
+              dep_tie[de] = pkey;
+              for (int n = 0; n < SPRAY_DEP_NUM; ++n) {
+                dep_vals[de * SPRAY_DEP_NUM + n] = run_vals[n];
+              }
+            } else {
+              addDepVals(
+                dep_box.atOffset(run_cell), run_vals.data(), fdat->mom_trans,
+                fdat->mass_trans, momSrcarr, rhoSrcarr, rhoYSrcarr, engSrcarr);
+            }
+            ++run_idx;
+          };
           // Subcycle loop
           for (int cur_iter = 0; cur_iter < num_iter && p.id() > 0;
                ++cur_iter) {
@@ -368,9 +672,9 @@ SprayParticleContainer::updateParticles(
 #ifdef AMREX_USE_EB
             if (eb_in_box) {
               do_fe_interp = eb_interp(
-                p, ijkc, ijk, dx, dxi, lx, plo, bflags, flags_array, ccent_fab,
-                bcent_fab, bnorm_fab, volfrac_fab, fdat->min_eb_vfrac,
-                indx_array.data(), weights.data());
+                p, ijkc, ijk, dx, dxi, lx, plo, bflags, stencil_fab,
+                stencil_data_fab, ccent_fab, bcent_fab, indx_array.data(),
+                weights.data());
             } else
 #endif
             {
@@ -385,12 +689,50 @@ SprayParticleContainer::updateParticles(
             // Solve for avg mw and pressure at droplet location
             gpv.define();
             fdat->calcBoilT(gpv, cBoilT.data());
+            Real cur_dt = sub_dt;
+            bool last_iter = (cur_iter == num_iter - 1);
+            if (adapt_sub) {
+              // If the parcel relaxes within the remaining time, it can
+              // reach the gas velocity. The relaxation time is unknown on
+              // the first subcycle
+              const bool relaxes =
+                (inv_tau_mom < 0. || t_rem * inv_tau_mom >= 1.);
+              Real cfl_rem = 0.;
+              for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                Real vel = std::abs(p.rdata(SprayComps::pstateVel + dir));
+                if (relaxes) {
+                  vel = amrex::max(vel, std::abs(gpv.vel_fluid[dir]));
+                }
+                cfl_rem = amrex::max(cfl_rem, t_rem * vel * dxi[dir]);
+              }
+              if (is_film || fdat->fixed_parts) {
+                cfl_rem = 0.;
+              }
+              // Subcycles needed to keep the parcel CFL below sub_cfl and to
+              // evaporate at most 20% of the parcel mass per subcycle
+              const int n_cfl = static_cast<int>(std::ceil(cfl_rem / sub_cfl));
+              const int n_evap =
+                static_cast<int>(std::ceil(t_rem * inv_tau_evap));
+              const int n_rem = amrex::min(
+                num_iter - cur_iter, amrex::max(1, amrex::max(n_cfl, n_evap)));
+              cur_dt = t_rem / static_cast<Real>(n_rem);
+              last_iter = (n_rem == 1);
+              t_rem -= cur_dt;
+            }
+            ++num_sub;
             if (is_film) {
               calculateFilmSource(
-                sub_dt, gpv, *fdat, p, cBoilT.data(), ltransparm);
+                cur_dt, gpv, *fdat, p, cBoilT.data(), ltransparm);
+              inv_tau_mom = 0.;
+              inv_tau_evap = 0.;
             } else {
               Reyn_d = calculateSpraySource(
-                sub_dt, gpv, *fdat, p, cBoilT.data(), ltransparm);
+                cur_dt, gpv, *fdat, p, cBoilT.data(), ltransparm, inv_tau_mom,
+                inv_tau_evap);
+            }
+            if (do_stats && stats.num_regions > 0) {
+              stats.addEvap(
+                stats_accum, p.pos(), -gpv.fluid_mass_src * cur_dt);
             }
             IntVect cur_indx = ijkc;
             Real cvol = inv_vol;
@@ -398,9 +740,9 @@ SprayParticleContainer::updateParticles(
               // Update breakup variables and determine if breakup occurs
               if (fdat->do_breakup == 1) {
                 Utan_total += updateBreakupTAB(
-                  Reyn_d, sub_dt, cBoilT.data(), gpv, *fdat, p);
+                  Reyn_d, cur_dt, cBoilT.data(), gpv, *fdat, p);
               }
-              if (cur_iter == num_iter - 1) {
+              if (last_iter) {
                 if (fdat->do_breakup == 1 && make_new_drops) {
                   // Determine if parcel must be split into multiple parcels
                   splitDropletTAB(pid, p, max_ppp, N_SB, rf_d, Utan_total);
@@ -418,35 +760,49 @@ SprayParticleContainer::updateParticles(
               cvol *= 1. / (volfrac_fab(cur_indx));
             }
 #endif
-            Real cur_coef = -cvol * sub_dt / flow_dt;
+            Real cur_coef = -cvol * cur_dt / flow_dt;
             if (!src_box.contains(cur_indx)) {
               if (!isGhost) {
                 Abort("SprayParticleContainer::updateParticles() -- source box "
                       "too small");
               }
             }
-            if (fdat->mom_trans) {
-              for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
-                Gpu::Atomic::Add(
-                  &momSrcarr(cur_indx, dir), cur_coef * gpv.fluid_mom_src[dir]);
-              }
+            GpuArray<Real, SPRAY_DEP_NUM> dv;
+            for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+              dv[dir] = cur_coef * gpv.fluid_mom_src[dir];
             }
-            if (fdat->mass_trans) {
-              Gpu::Atomic::Add(
-                &rhoSrcarr(cur_indx), cur_coef * gpv.fluid_mass_src);
-              for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
-                Gpu::Atomic::Add(
-                  &rhoYSrcarr(cur_indx, spf), cur_coef * gpv.fluid_Y_dot[spf]);
+            dv[AMREX_SPACEDIM] = cur_coef * gpv.fluid_mass_src;
+            for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+              dv[AMREX_SPACEDIM + 1 + spf] = cur_coef * gpv.fluid_Y_dot[spf];
+            }
+            dv[SPRAY_DEP_NUM - 1] = cur_coef * gpv.fluid_eng_src;
+            if (sort_depos) {
+              // Sum the contributions of the current run, these are summed
+              // per cell after all parcels have been updated
+              const int cell = dep_box.contains(cur_indx)
+                                 ? static_cast<int>(dep_box.index(cur_indx))
+                                 : trash_bin;
+              if (cell != run_cell) {
+                store_run();
+                run_cell = cell;
+                run_vals = dv;
+              } else {
+                for (int n = 0; n < SPRAY_DEP_NUM; ++n) {
+                  run_vals[n] += dv[n];
+                }
               }
+            } else {
+              addDepVals(
+                cur_indx, dv.data(), fdat->mom_trans, fdat->mass_trans,
+                momSrcarr, rhoSrcarr, rhoYSrcarr, engSrcarr);
             }
-            Gpu::Atomic::Add(
-              &engSrcarr(cur_indx), cur_coef * gpv.fluid_eng_src);
             // Real new_time = static_cast<Real>(cur_iter + 1) * sub_dt;
             // Modify particle position by whole time step
             if (do_move && !fdat->fixed_parts && p.id() > 0 && !is_film) {
+              const RealVect old_pos = p.pos();
               for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
                 const Real cvel = p.rdata(SprayComps::pstateVel + dir);
-                p.pos(dir) += sub_dt * cvel;
+                p.pos(dir) += cur_dt * cvel;
               }
               if (at_bounds || do_fe_interp) {
                 // First check if particle has exited the domain through a
@@ -475,30 +831,110 @@ SprayParticleContainer::updateParticles(
               ijk = lx.floor();
               lxc = (p.pos() - plo) * dxi;
               ijkc = lxc.floor(); // New cell center
+              if (do_stats && stats.num_planes > 0) {
+                Real cp_part = 0.;
+                const Real pmass = p.rdata(SprayComps::pstateNumDens) *
+                                   parcelDropMass(p, *fdat, cp_part);
+                stats.addFlux(stats_accum, old_pos, p.pos(), pmass);
+              }
             }
             if (isGhost && !src_box.contains(ijkc)) {
               p.id() = -1;
             }
+            if (last_iter) {
+              break;
+            }
           } // End of subcycle loop
+          if (sort_depos) {
+            store_run();
+          }
+          if (sub_hist_ptr != nullptr) {
+            Gpu::Atomic::AddNoRet(&sub_hist_ptr[num_sub], 1);
+          }
         } // End of p.id() > 0 check
       }); // End of loop over particles
-      if (make_new_drops) {
+      if (sort_depos) {
+        // The cells of dep_box are only exclusive to this tile if the tile
+        // covers the whole grid
+        const bool exclusive = (tile_box == pti.validbox());
+        int num_extra = 0;
         Gpu::copy(
-          Gpu::deviceToHost, N_SB_d.begin(), N_SB_d.end(), N_SB_h.begin());
-        bool get_new_parts = false;
-        for (int n = 0; n < Np; n++) {
-          if (N_SB_h[n] != splash_breakup::no_change) {
-            get_new_parts = true;
-          }
-        }
-        if (get_new_parts) {
-          refv.retrieve_data();
-          SBPtrs rfh;
-          refv.fillPtrs_h(rfh);
-          CreateSBDroplets(Np, sub_dt, N_SB_h.data(), rfh, level);
+          Gpu::deviceToHost, dep_extra_v.begin(), dep_extra_v.end(),
+          &num_extra);
+        const Long num_runs =
+          Np + amrex::min(static_cast<Long>(num_extra), static_cast<Long>(Np));
+        depositSortedSources(
+          dep_box, exclusive, num_runs, dep_cell, dep_run, dep_tie, dep_vals,
+          m_sprayData->mom_trans, m_sprayData->mass_trans, momSrcarr,
+          rhoSrcarr, rhoYSrcarr, engSrcarr);
+      }
+      if (adapt_sub) {
+        Vector<int> sub_hist_h(num_iter + 1);
+        Gpu::copy(
+          Gpu::deviceToHost, sub_hist_d.begin(), sub_hist_d.end(),
+          sub_hist_h.begin());
+#ifdef AMREX_USE_OMP
+#pragma omp critical(spray_sub_hist)
+#endif
+        for (int n = 1; n <= num_iter; ++n) {
+          sub_hist[n] += sub_hist_h[n];
+          num_updates += static_cast<Long>(n) * sub_hist_h[n];
         }
       }
+      if (make_new_drops) {
+        lost_sb_mass += CreateSBDroplets(
+          pti.GetParticleTile(), Np, sub_dt, N_SB, rf_d, level);
+      }
       Gpu::streamSynchronize();
     } // for (int MyParIter pti..
   }
+  if (m_verbose > 0 && (do_breakup || do_splash) && isActive && do_move) {
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceRealSum(lost_sb_mass, IOProc);
+    if (lost_sb_mass > 0.) {
+      Print() << "SprayParticleContainer::updateParticles() on level "
+              << level << ": removed splash and breakup parcels outside of "
+              << "the domain with a liquid mass of " << lost_sb_mass
+              << std::endl;
+    }
+  }
+  if (m_verbose > 1) {
+    const int IOProc = ParallelDescriptor::IOProcessorNumber();
+    Real run_time = ParallelDescriptor::second() - strt_time;
+    ParallelDescriptor::ReduceRealMax(run_time, IOProc);
+    ParallelDescriptor::ReduceLongSum(num_updates, IOProc);
+    if (run_time > 0.) {
+      Print() << "SprayParticleContainer::updateParticles() on level "
+              << level << ": " << num_updates << " parcel updates in "
+              << run_time << " s, "
+              << static_cast<Real>(num_updates) / run_time
+              << " parcel updates/s" << std::endl;
+    }
+    if (adapt_sub) {
+      ParallelDescriptor::ReduceLongSum(sub_hist.data(), num_iter + 1, IOProc);
+      Long num_parts = 0;
+      for (int n = 1; n <= num_iter; ++n) {
+        num_parts += sub_hist[n];
+      }
+      // Subcycle counts of the median and 99th percentile parcels
+      int n_50 = 0;
+      int n_99 = 0;
+      Long cum_parts = 0;
+      for (int n = 1; n <= num_iter; ++n) {
+        cum_parts += sub_hist[n];
+        if (n_50 == 0 && 2 * cum_parts >= num_parts) {
+          n_50 = n;
+        }
+        if (n_99 == 0 && 100 * cum_parts >= 99 * num_parts) {
+          n_99 = n;
+        }
+      }
+      Print() << "  Parcel subcycles (max " << num_iter << "): median " << n_50
+              << ", 99th percentile " << n_99 << ", counts";
+      for (int n = 1; n <= num_iter; ++n) {
+        Print() << " " << sub_hist[n];
+      }
+      Print() << std::endl;
+    }
+  }
 }
@@ -1,85 +1,150 @@
-
 #include "SprayParticles.H"
 #include "SBData.H"
 #include "AhamedSplash.H"
 #include "Distributions.H"
+#include <AMReX_Scan.H>
 
 using namespace amrex;
 
-void
+// Number of parcels created from a splashing or breaking up parcel
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE int
+numSBDroplets(
+  const splash_breakup N_SB, const Real num_dens0, const Real ppp_fact)
+{
+  if (N_SB == splash_breakup::no_change) {
+    return 0;
+  }
+  // Four secondary parcels are created during splashing
+  if (N_SB >= splash_breakup::splash_dry_splash) {
+    return 4;
+  }
+  // num_dens0 = N_s N_d, where N_d - number of newly created parcels and
+  // N_s - number density of newly created parcels There is no one way to
+  // do this
+  const Real N_s = std::pow(num_dens0, ppp_fact);
+  return amrex::max(1, static_cast<int>(num_dens0 / N_s));
+}
+
+Real
 SprayParticleContainer::CreateSBDroplets(
+  ParticleTileType& ptile,
   const int Np,
   const Real sub_dt,
-  const splash_breakup* N_SB_h,
-  const SBPtrs& rfh,
+  const splash_breakup* N_SB,
+  const SBPtrs& rf,
   const int level)
 {
-  ParticleLocData pld;
-  const SprayData* fdat = m_sprayData;
-  std::map<std::pair<int, int>, Gpu::HostVector<ParticleType>> host_particles;
-  std::pair<int, int> ind(pld.m_grid, pld.m_tile);
-  for (int n = 0; n < Np; n++) {
-    if (N_SB_h[n] != splash_breakup::no_change) {
+  BL_PROFILE("SprayParticleContainer::CreateSBDroplets()");
+  const Real ppp_fact = m_breakupPPPFact;
+  // Count the new parcels of each parcel and find where they are stored
+  Gpu::DeviceVector<int> num_new_v(Np);
+  Gpu::DeviceVector<int> new_offset_v(Np);
+  int* num_new = num_new_v.data();
+  int* new_offset = new_offset_v.data();
+  amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+    num_new[pid] = numSBDroplets(N_SB[pid], rf.num_dens[pid], ppp_fact);
+  });
+  const int total_new =
+    Scan::ExclusiveSum(Np, num_new, new_offset, Scan::retSum);
+  if (total_new == 0) {
+    return 0.;
+  }
+  // Reserve a contiguous range of ids for the new parcels
+  Long id_start = 0;
+#ifdef AMREX_USE_OMP
+#pragma omp critical(spray_sb_nextid)
+#endif
+  {
+    id_start = ParticleType::NextID();
+    ParticleType::NextID(id_start + total_new);
+  }
+  const int my_proc = ParallelDescriptor::MyProc();
+  // The new parcels are appended to the current tile, parcels that are
+  // outside of it are moved to the correct tile by the next Redistribute
+  const int old_size = static_cast<int>(ptile.GetArrayOfStructs().size());
+  ptile.resize(old_size + total_new);
+  const auto ptd = ptile.getParticleTileData();
+  const SprayData* fdat = d_sprayData;
+  // New parcels must be inside the domain in the non-periodic directions
+  const auto plo = this->Geom(level).ProbLoArray();
+  const auto phi = this->Geom(level).ProbHiArray();
+  const auto is_per = this->Geom(level).isPeriodicArray();
+  Gpu::DeviceVector<Real> lost_mass_v(1, 0.);
+  Real* lost_mass = lost_mass_v.data();
+  amrex::ParallelForRNG(
+    Np, [=] AMREX_GPU_DEVICE(int n, RandomEngine const& engine) noexcept {
+      const int N_d = num_new[n];
+      if (N_d == 0) {
+        return;
+      }
+      const int start = old_size + new_offset[n];
+      const Long start_id = id_start + new_offset[n];
       RealVect normal;
       RealVect loc0;
       RealVect vel0;
       const int vn = AMREX_SPACEDIM * n;
       for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
-        normal[dir] = rfh.norm[vn + dir];
-        loc0[dir] = rfh.loc[vn + dir];
-        vel0[dir] = rfh.vel[vn + dir];
+        normal[dir] = rf.norm[vn + dir];
+        loc0[dir] = rf.loc[vn + dir];
+        vel0[dir] = rf.vel[vn + dir];
       }
-      Real ref_dia = rfh.ref_dia[n];
-
-      Real num_dens0 = rfh.num_dens[n];
+      const Real ref_dia = rf.ref_dia[n];
+      const Real num_dens0 = rf.num_dens[n];
       // These values differ depending on breakup or splashing
       // Splashing: Kv
       // Breakup: Utan
-      Real phi1 = rfh.phi1[n];
+      const Real phi1 = rf.phi1[n];
 
       // Splashing: ms, splash amount
       // TAB Breakup: TAB y value
       // KH-RT Breakup: Unused
-      Real phi2 = rfh.phi2[n];
+      const Real phi2 = rf.phi2[n];
 
       // Splashing: film thickness / droplet diameter
       // TAB Breakup: TAB y dot value
       // KH-RT Breakup: Unused
-      Real phi3 = rfh.phi3[n];
-      Real T0 = rfh.T0[n];
-      Array<Real, SPRAY_FUEL_NUM> Y0 = {{0.0}};
+      const Real phi3 = rf.phi3[n];
+      const Real T0 = rf.T0[n];
+      Real Y0[SPRAY_FUEL_NUM] = {0.0};
 #if SPRAY_FUEL_NUM > 1
       Real rho_part = 0.;
-      Real mu_part = 0.;
       const int vy = SPRAY_FUEL_NUM * n;
       for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
-        Y0[spf] = rfh.Y0[vy + spf];
+        Y0[spf] = rf.Y0[vy + spf];
         rho_part += Y0[spf] / fdat->rhoL(T0, spf);
-        mu_part += Y0[spf] * fdat->muL(T0, spf);
       }
       rho_part = 1. / rho_part;
 #else
-      Real rho_part = fdat->rhoL(T0, 0);
-      // Real mu_part = fdat->muL(T0, 0);
+      const Real rho_part = fdat->rhoL(T0, 0);
       Y0[0] = 1.;
 #endif
-      // Real pmass = M_PI / 6. * rho_part * std::pow(ref_dia, 3);
-      Real U0mag = vel0.vectorLength();
+      // Set the id and the values that are the same for all new parcels
+      for (int new_parts = 0; new_parts < N_d; ++new_parts) {
+        auto& pnew = ptd.m_aos[start + new_parts];
+        pnew.id() = start_id + new_parts;
+        pnew.cpu() = my_proc;
+        const SprayParticleRef p(ptd, start + new_parts);
+        p.rdata(SprayComps::pstateT) = T0;
+        for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+          p.rdata(SprayComps::pstateY + spf) = Y0[spf];
+        }
+        p.rdata(SprayComps::pstateFilmHght) = 0.;
+      }
 
       // Splashing
-      if (N_SB_h[n] >= splash_breakup::splash_dry_splash) {
+      if (N_SB[n] >= splash_breakup::splash_dry_splash) {
+        const Real U0mag = vel0.vectorLength();
         // tanPsi: parallel with wall, perpendicular to velocity
         // tanBeta: parallel with wall, in plane with velocity
         RealVect tanPsi, tanBeta;
         find_tangents(vel0, tanPsi, normal, tanBeta);
-        Real Kv = phi1;
-        Real ms = phi2;
-        Real del_film = phi3;
-        Real U0norm = normal.dotProduct(vel0);
-        Real alpha =
+        const Real Kv = phi1;
+        const Real ms = phi2;
+        const Real del_film = phi3;
+        const Real U0norm = normal.dotProduct(vel0);
+        const Real alpha =
           amrex::max(M_PI / 6., std::asin(amrex::Math::abs(U0norm) / U0mag));
-        // Real alpha_d = alpha * 180. / M_PI;
-        Real U0tan = std::sqrt(U0mag * U0mag - U0norm * U0norm);
+        const Real U0tan = std::sqrt(U0mag * U0mag - U0norm * U0norm);
         Real uBeta_0, uBeta_half, uBeta_pi, uPsi_coeff, usNorm;
         get_splash_vels(
           U0norm, U0tan, Kv, del_film, uBeta_0, uBeta_half, uBeta_pi,
@@ -90,11 +155,9 @@ SprayParticleContainer::CreateSBDroplets(
         get_ms_theta(alpha, ms, del_film, ms_thetas);
         // Note: Must be -pi/2 < psi < pi, not 0 < psi < pi for symmetry
         for (int new_parts = 0; new_parts < Nsint; ++new_parts) {
-          ParticleType p;
-          p.id() = ParticleType::NextID();
-          p.cpu() = ParallelDescriptor::MyProc();
-          Real new_mass = ms_thetas[new_parts];
-          Real dia_part = std::cbrt(6. * new_mass / (M_PI * rho_part));
+          const SprayParticleRef p(ptd, start + new_parts);
+          const Real new_mass = ms_thetas[new_parts];
+          const Real dia_part = std::cbrt(6. * new_mass / (M_PI * rho_part));
           p.rdata(SprayComps::pstateDia) = dia_part;
           Real utBeta = uBeta_half;
           if (new_parts == 1) {
@@ -106,38 +169,21 @@ SprayParticleContainer::CreateSBDroplets(
             , , Real psi = 0.5 * M_PI * (static_cast<Real>(new_parts) - 1.);
             Real utPsi = uPsi_coeff * std::sin(psi);)
           for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
-            Real pvel = AMREX_D_TERM(
+            const Real pvel = AMREX_D_TERM(
               usNorm * normal[dir], +utBeta * tanBeta[dir],
               +utPsi * tanPsi[dir]);
             p.pos(dir) = loc0[dir] + dia_part * normal[dir];
             p.rdata(SprayComps::pstateVel + dir) = pvel;
           }
-          for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
-            p.rdata(SprayComps::pstateY + spf) = Y0[spf];
-          }
           p.rdata(SprayComps::pstateBM1) = 0.;
           p.rdata(SprayComps::pstateBM2) = 0.;
-          p.rdata(SprayComps::pstateFilmHght) = 0.;
           p.rdata(SprayComps::pstateN0) = num_dens0;
           p.rdata(SprayComps::pstateNumDens) = num_dens0;
-          bool where = Where(p, pld);
-          if (!where) {
-            amrex::Abort("Bad reflected particle");
-          }
-          p.rdata(SprayComps::pstateT) = T0;
-          host_particles[ind].push_back(p);
         }
         // Breakup
       } else {
-        Real Utan = phi1;
-        Real dmean = ref_dia;
-        // num_dens0 = N_s N_d, where N_d - number of newly created parcels and
-        // N_s - number density of newly created parcels There is no one way to
-        // do this
-        Real N_s = std::pow(num_dens0, m_breakupPPPFact);
-        int N_d = amrex::max(1, static_cast<int>(num_dens0 / N_s));
-        N_s = num_dens0 / static_cast<Real>(N_d);
-        // Real new_mass = M_PI / 6. * rho_part * std::pow(dmean, 3);
+        const Real Utan = phi1;
+        const Real N_s = num_dens0 / static_cast<Real>(N_d);
 #if AMREX_SPACEDIM == 3
         RealVect testvec(1., 0., 0.);
         if (testvec.crossProduct(normal).vectorLength() < 1.E-5) {
@@ -151,58 +197,57 @@ SprayParticleContainer::CreateSBDroplets(
         RealVect tanBeta(normal[1], normal[0]);
 #endif
         for (int new_parts = 0; new_parts < N_d; ++new_parts) {
-          Real rand = amrex::Random();
-          ParticleType p;
-          p.id() = ParticleType::NextID();
-          p.cpu() = ParallelDescriptor::MyProc();
-          p.rdata(SprayComps::pstateDia) = dmean;
-          p.rdata(SprayComps::pstateT) = T0;
-          for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
-            p.rdata(SprayComps::pstateY + spf) = Y0[spf];
-          }
-          if (m_sprayData->do_breakup == 2) {
+          const Real rand = amrex::Random(engine);
+          const SprayParticleRef p(ptd, start + new_parts);
+          p.rdata(SprayComps::pstateDia) = ref_dia;
+          if (fdat->do_breakup == 2) {
             p.rdata(SprayComps::pstateBM1) = 0.;
             p.rdata(SprayComps::pstateBM2) = 0.;
           } else {
             p.rdata(SprayComps::pstateBM1) = phi2;
             p.rdata(SprayComps::pstateBM2) = phi3;
           }
-
-          p.rdata(SprayComps::pstateFilmHght) = 0.;
           p.rdata(SprayComps::pstateN0) = N_s;
           p.rdata(SprayComps::pstateNumDens) = N_s;
           for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
 #if AMREX_SPACEDIM == 3
-            Real psi = rand * 2. * M_PI;
-            Real pvel = vel0[dir] + Utan * (std::sin(psi) * tanPsi[dir] +
-                                            std::cos(psi) * tanBeta[dir]);
+            const Real psi = rand * 2. * M_PI;
+            const Real pvel =
+              vel0[dir] + Utan * (std::sin(psi) * tanPsi[dir] +
+                                  std::cos(psi) * tanBeta[dir]);
 #else
-            Real sgn = std::copysign(1., 0.5 - rand);
-            Real pvel = vel0[dir] + sgn * Utan * tanBeta[dir];
+            const Real sgn = std::copysign(1., 0.5 - rand);
+            const Real pvel = vel0[dir] + sgn * Utan * tanBeta[dir];
 #endif
             p.pos(dir) = loc0[dir] + sub_dt * pvel;
             p.rdata(SprayComps::pstateVel + dir) = pvel;
           }
-          bool where = Where(p, pld);
-          if (!where) {
-            amrex::Abort("Bad breakup particle");
+        }
+      }
+      // Remove the new parcels that could not be placed in the domain and
+      // count their mass as lost
+      for (int new_parts = 0; new_parts < N_d; ++new_parts) {
+        const SprayParticleRef p(ptd, start + new_parts);
+        bool in_domain = true;
+        for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+          if (
+            is_per[dir] == 0 &&
+            (p.pos(dir) < plo[dir] || p.pos(dir) >= phi[dir])) {
+            in_domain = false;
           }
-          host_particles[ind].push_back(p);
+        }
+        AMREX_ASSERT_WITH_MESSAGE(in_domain, "Bad breakup particle");
+        if (!in_domain) {
+          Real cp_part = 0.;
+          Gpu::Atomic::AddNoRet(
+            lost_mass, p.rdata(SprayComps::pstateNumDens) *
+                         parcelDropMass(p, *fdat, cp_part));
+          p.id() = -1;
         }
       }
-    }
-  }
-  for (auto& kv : host_particles) {
-    auto grid = kv.first.first;
-    auto tile = kv.first.second;
-    const auto& src_tile = kv.second;
-    auto& dst_tile = GetParticles(level)[std::make_pair(grid, tile)];
-    auto old_size = dst_tile.GetArrayOfStructs().size();
-    auto new_size = old_size + src_tile.size();
-    dst_tile.resize(new_size);
-    // Copy the AoS part of the host particles to the GPU
-    Gpu::copy(
-      Gpu::hostToDevice, src_tile.begin(), src_tile.end(),
-      dst_tile.GetArrayOfStructs().begin() + old_size);
-  }
+    });
+  Real lost_mass_h = 0.;
+  Gpu::copy(
+    Gpu::deviceToHost, lost_mass_v.begin(), lost_mass_v.end(), &lost_mass_h);
+  return lost_mass_h;
 }
@@ -12,11 +12,32 @@ SprayComps SprayParticleContainer::m_sprayIndx;
 Real SprayParticleContainer::spray_cfl = 0.5;
 bool SprayParticleContainer::write_ascii_files = false;
 bool SprayParticleContainer::plot_spray_src = false;
+bool SprayParticleContainer::sorted_deposition = false;
+bool SprayParticleContainer::adaptive_subcycling = false;
 Real SprayParticleContainer::m_maxNumPPP = 100.;
 Real SprayParticleContainer::m_breakupPPPFact = 0.5;
 Real SprayParticleContainer::m_khrtB0 = 0.61;
 Real SprayParticleContainer::m_khrtB1 = 7.;
 Real SprayParticleContainer::m_khrtC3 = 1.;
+int SprayParticleContainer::m_mergeInt = 0;
+int SprayParticleContainer::m_mergeMaxPPC = 16;
+Real SprayParticleContainer::m_mergeDiaTol = 0.1;
+Real SprayParticleContainer::m_mergeVelTol = 0.1;
+Real SprayParticleContainer::m_mergeTempTol = 5.;
+bool SprayParticleContainer::m_doCollision = false;
+Real SprayParticleContainer::m_collCutoff = 1.E-6;
+int SprayParticleContainer::m_collSeed = 0;
+int SprayParticleContainer::m_statsInt = 0;
+std::string SprayParticleContainer::m_statsFile = "spray_stats";
+SprayStatsData SprayParticleContainer::m_statsData;
+Real* SprayParticleContainer::m_statsAccumD = nullptr;
+Real SprayParticleContainer::m_statsTime = 0.;
+int SprayParticleContainer::m_propTabSize = 0;
+int SprayParticleContainer::m_propTabInterp = 1;
+Real SprayParticleContainer::m_propTabTmin = 200.;
+Real SprayParticleContainer::m_propTabTol = 1.E-3;
+Real* SprayParticleContainer::m_propTabH = nullptr;
+Real* SprayParticleContainer::m_propTabD = nullptr;
 std::string SprayParticleContainer::spray_init_file;
 
 void
@@ -196,6 +217,118 @@ SprayParticleContainer::readSprayParams(int& particle_verbose)
   //
   pp.query("plot_src", plot_spray_src);
   //
+  // Set if source terms are deposited by binning parcels by cell instead of
+  // with atomic updates
+  //
+  pp.query("sorted_deposition", sorted_deposition);
+  //
+  // Set if each parcel chooses its own number of spray subcycles
+  //
+  pp.query("adaptive_subcycling", adaptive_subcycling);
+  //
+  // Tabulate the liquid fuel properties in temperature
+  //
+  pp.query("prop_table_size", m_propTabSize);
+  if (m_propTabSize > 0) {
+    pp.query("prop_table_interp", m_propTabInterp);
+    pp.query("prop_table_Tmin", m_propTabTmin);
+    pp.query("prop_table_tol", m_propTabTol);
+    if (m_propTabSize < 4) {
+      Abort("'prop_table_size' must be at least 4");
+    }
+    if (m_propTabInterp != 1 && m_propTabInterp != 3) {
+      Abort("'prop_table_interp' must be 1 (linear) or 3 (cubic)");
+    }
+  }
+  //
+  // Parcel merging parameters
+  //
+  pp.query("merge_int", m_mergeInt);
+  if (m_mergeInt > 0) {
+    pp.query("merge_max_parcels", m_mergeMaxPPC);
+    pp.query("merge_dia_tol", m_mergeDiaTol);
+    pp.query("merge_vel_tol", m_mergeVelTol);
+    pp.query("merge_temp_tol", m_mergeTempTol);
+    if (m_mergeMaxPPC < 1) {
+      Abort("'merge_max_parcels' must be at least 1");
+    }
+  }
+  //
+  // Droplet collision parameters
+  //
+  pp.query("do_collision", m_doCollision);
+  if (m_doCollision) {
+    pp.query("collision_cutoff", m_collCutoff);
+    pp.query("collision_seed", m_collSeed);
+    // The surface tension is otherwise only read for splash or breakup
+    if (!pp.contains("fuel_sigma")) {
+      Abort("fuel_sigma must be set for droplet collisions");
+    }
+    pp.get("fuel_sigma", m_sprayData->sigma);
+  }
+  //
+  // In-situ spray statistics parameters
+  //
+  pp.query("stats_int", m_statsInt);
+  if (m_statsInt > 0) {
+    SprayStatsData& sd = m_statsData;
+    pp.query("stats_file", m_statsFile);
+    sd.num_dia_bins = 50;
+    sd.num_vel_bins = 20;
+    pp.query("stats_dia_bins", sd.num_dia_bins);
+    pp.get("stats_dia_max", sd.dia_max);
+    pp.query("stats_vel_bins", sd.num_vel_bins);
+    pp.get("stats_vel_max", sd.vel_max);
+    pp.query("stats_vel_dir", sd.vel_dir);
+    if (
+      sd.num_dia_bins < 1 || sd.num_vel_bins < 1 || sd.dia_max <= 0. ||
+      sd.vel_max <= 0.) {
+      Abort("Spray statistics bins and ranges must be positive");
+    }
+    if (sd.vel_dir >= AMREX_SPACEDIM) {
+      Abort("'stats_vel_dir' must be -1 or a valid direction");
+    }
+    std::vector<int> plane_dirs;
+    std::vector<Real> plane_locs;
+    pp.queryarr("stats_plane_dirs", plane_dirs);
+    pp.queryarr("stats_plane_locs", plane_locs);
+    sd.num_planes = static_cast<int>(plane_dirs.size());
+    if (
+      sd.num_planes > SprayStatsData::max_planes ||
+      plane_locs.size() != plane_dirs.size()) {
+      Abort(
+        "'stats_plane_dirs' and 'stats_plane_locs' must have the same length "
+        "of at most " +
+        std::to_string(SprayStatsData::max_planes));
+    }
+    for (int pl = 0; pl < sd.num_planes; ++pl) {
+      if (plane_dirs[pl] < 0 || plane_dirs[pl] >= AMREX_SPACEDIM) {
+        Abort("'stats_plane_dirs' must be valid directions");
+      }
+      sd.plane_dir[pl] = plane_dirs[pl];
+      sd.plane_loc[pl] = plane_locs[pl];
+    }
+    std::vector<Real> reg_lo;
+    std::vector<Real> reg_hi;
+    pp.queryarr("stats_region_lo", reg_lo);
+    pp.queryarr("stats_region_hi", reg_hi);
+    sd.num_regions = static_cast<int>(reg_lo.size()) / AMREX_SPACEDIM;
+    if (
+      sd.num_regions > SprayStatsData::max_regions ||
+      reg_lo.size() != reg_hi.size() ||
+      reg_lo.size() != static_cast<size_t>(sd.num_regions * AMREX_SPACEDIM)) {
+      Abort(
+        "'stats_region_lo' and 'stats_region_hi' must hold AMREX_SPACEDIM "
+        "values for each of at most " +
+        std::to_string(SprayStatsData::max_regions) + " regions");
+    }
+    for (size_t n = 0; n < reg_lo.size(); ++n) {
+      sd.reg_lo[n] = reg_lo[n];
+      sd.reg_hi[n] = reg_hi[n];
+    }
+    sd.setOffsets();
+  }
+  //
   // Used in initData() on startup to read in a file of particles.
   //
   pp.query("init_file", spray_init_file);
@@ -291,11 +424,105 @@ SprayParticleContainer::spraySetup(const Real* body_force)
   for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
     m_sprayData->body_force[dir] = body_force[dir];
   }
-  Gpu::copy(Gpu::hostToDevice, m_sprayData, m_sprayData + 1, d_sprayData);
+  m_sprayData->setBoilFact();
+  if (m_propTabSize > 0) {
+    buildPropTable();
+  }
+  if (m_statsInt > 0 && m_statsAccumD == nullptr) {
+    const int nvals = m_statsData.num_vals;
+    m_statsAccumD =
+      static_cast<Real*>(The_Arena()->alloc(nvals * sizeof(Real)));
+    Real* accum = m_statsAccumD;
+    amrex::ParallelFor(
+      nvals, [=] AMREX_GPU_DEVICE(int n) noexcept { accum[n] = 0.; });
+  }
+  // The device copy points to the device property tables
+  SprayData dev_data = *m_sprayData;
+  dev_data.prop_tab = m_propTabD;
+  Gpu::copy(Gpu::hostToDevice, &dev_data, &dev_data + 1, d_sprayData);
   Gpu::streamSynchronize();
   ParallelDescriptor::Barrier();
 }
 
+void
+SprayParticleContainer::buildPropTable()
+{
+  SprayData* fdat = m_sprayData;
+  const int nt = m_propTabSize;
+  const int nprops = SprayData::num_tab_props;
+  Real Tmax = 0.;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    Tmax = amrex::max(Tmax, fdat->critT[spf]);
+  }
+  if (m_propTabTmin >= Tmax) {
+    Abort("'prop_table_Tmin' must be less than the critical temperature");
+  }
+  const Real dT = (Tmax - m_propTabTmin) / static_cast<Real>(nt - 1);
+  const std::size_t tab_size =
+    static_cast<std::size_t>(SPRAY_FUEL_NUM) * nprops * nt;
+  if (m_propTabH == nullptr) {
+    m_propTabH = static_cast<Real*>(
+      The_Pinned_Arena()->alloc(tab_size * sizeof(Real)));
+    m_propTabD =
+      static_cast<Real*>(The_Arena()->alloc(tab_size * sizeof(Real)));
+  }
+  // Only the Antoine equation is tabulated for the saturation pressure, the
+  // Clausius-Clapeyron form depends on the gas phase enthalpy
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    Real* tab = m_propTabH + static_cast<std::size_t>(spf) * nprops * nt;
+    for (int i = 0; i < nt; ++i) {
+      const Real T = m_propTabTmin + static_cast<Real>(i) * dT;
+      tab[SprayData::tab_rho * nt + i] = fdat->rhoLFit(T, spf);
+      tab[SprayData::tab_mu * nt + i] = fdat->muLFit(T, spf);
+      tab[SprayData::tab_lambda * nt + i] = fdat->lambdaLFit(T, spf);
+      tab[SprayData::tab_psat * nt + i] = fdat->psatFit(T, spf);
+    }
+  }
+  Gpu::copy(Gpu::hostToDevice, m_propTabH, m_propTabH + tab_size, m_propTabD);
+  fdat->tab_num = nt;
+  fdat->tab_interp = m_propTabInterp;
+  fdat->tab_Tmin = m_propTabTmin;
+  fdat->tab_Tmax = Tmax;
+  fdat->tab_dTinv = 1. / dT;
+  fdat->prop_tab = m_propTabH;
+
+  // Check the interpolated values between the table points against the
+  // analytic forms
+  const std::string prop_names[nprops] = {"rhoL", "muL", "lambdaL", "psat"};
+  Real max_err[nprops] = {0.};
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    for (int i = 0; i < nt - 1; ++i) {
+      for (int n = 1; n < 4; ++n) {
+        const Real T = m_propTabTmin + (static_cast<Real>(i) + 0.25 * n) * dT;
+        const Real exact[nprops] = {
+          fdat->rhoLFit(T, spf), fdat->muLFit(T, spf),
+          fdat->lambdaLFit(T, spf), fdat->psatFit(T, spf)};
+        for (int prop = 0; prop < nprops; ++prop) {
+          const Real err = std::abs(fdat->tabValue(T, spf, prop) - exact[prop]);
+          if (err > 0.) {
+            max_err[prop] =
+              amrex::max(max_err[prop], err / std::abs(exact[prop]));
+          }
+        }
+      }
+    }
+  }
+  Print() << "Spray liquid property tables with " << nt << " points from "
+          << m_propTabTmin << " K to " << Tmax
+          << " K, maximum relative errors:";
+  bool exceeded = false;
+  for (int prop = 0; prop < nprops; ++prop) {
+    Print() << " " << prop_names[prop] << " " << max_err[prop];
+    exceeded = exceeded || (max_err[prop] > m_propTabTol);
+  }
+  Print() << std::endl;
+  if (exceeded) {
+    Warning(
+      "Spray property table error exceeds particles.prop_table_tol, "
+      "increase particles.prop_table_size");
+  }
+}
+
 void
 SprayParticleContainer::SprayInitialize(const std::string& restart_dir)
 {
@@ -305,7 +532,7 @@ SprayParticleContainer::SprayInitialize(const std::string& restart_dir)
   }
   InitSprayParticles(init_sprays);
   if (!spray_init_file.empty()) {
-    InitFromAsciiFile(spray_init_file, NSR_SPR);
+    InitFromAsciiFile(spray_init_file, NSR_SPR + NAR_SPR);
   } else if (!restart_dir.empty()) {
     Restart(restart_dir, "particles");
   }
@@ -91,6 +91,10 @@ main(int argc, char* argv[])
           });
       }
     }
+    // Initial temperatures, used as the guess of the state recovery benchmark
+    amrex::MultiFab temperature_guess(ba, dm, 1, num_grow);
+    amrex::MultiFab::Copy(temperature_guess, temperature, 0, 0, 1, num_grow);
+
     amrex::MultiFab cp(ba, dm, 1, num_grow);
     amrex::MultiFab wdot(ba, dm, NUM_SPECIES, num_grow);
     {
@@ -159,6 +163,108 @@ main(int argc, char* argv[])
           });
       }
     }
+    // Benchmark the fused state recovery against the per-call sequence
+    {
+      // Number of repeated evaluations used to time the recovery kernels
+      int niter = 1;
+      pp.query("niter", niter);
+
+#ifdef USE_MANIFOLD_EOS
+      const int outputs = pele::physics::eos::recover_P |
+                          pele::physics::eos::recover_Cp;
+#else
+      const int outputs = pele::physics::eos::recover_all;
+#endif
+      const int nstate = 5;
+      amrex::MultiFab T_seq(ba, dm, 1, num_grow);
+      amrex::MultiFab T_fused(ba, dm, 1, num_grow);
+      amrex::MultiFab state_seq(ba, dm, nstate, num_grow);
+      amrex::MultiFab state_fused(ba, dm, nstate, num_grow);
+      state_seq.setVal(0.0);
+      state_fused.setVal(0.0);
+
+      amrex::Real strt_time = amrex::ParallelDescriptor::second();
+      for (int iter = 0; iter < niter; ++iter) {
+        BL_PROFILE("Pele::get_state_percall()");
+        amrex::MultiFab::Copy(T_seq, temperature_guess, 0, 0, 1, num_grow);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (amrex::MFIter mfi(mass_frac, amrex::TilingIfNotGPU());
+             mfi.isValid(); ++mfi) {
+
+          const amrex::Box& box = mfi.tilebox();
+
+          auto const& Y_a = mass_frac.const_array(mfi);
+          auto const& e_a = energy.const_array(mfi);
+          auto const& rho_a = density.const_array(mfi);
+          auto const& T_a = T_seq.array(mfi);
+          auto const& state_a = state_seq.array(mfi);
+          amrex::ParallelFor(
+            box, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+              get_state_percall(
+                i, j, k, Y_a, rho_a, e_a, T_a, state_a, leosparm);
+            });
+        }
+        amrex::Gpu::streamSynchronize();
+      }
+      amrex::Real seq_time = amrex::ParallelDescriptor::second() - strt_time;
+      amrex::ParallelDescriptor::ReduceRealMax(
+        seq_time, amrex::ParallelDescriptor::IOProcessorNumber());
+
+      strt_time = amrex::ParallelDescriptor::second();
+      for (int iter = 0; iter < niter; ++iter) {
+        BL_PROFILE("Pele::recover_state()");
+        amrex::MultiFab::Copy(T_fused, temperature_guess, 0, 0, 1, num_grow);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (amrex::MFIter mfi(mass_frac, amrex::TilingIfNotGPU());
+             mfi.isValid(); ++mfi) {
+
+          const amrex::Box& gbox = mfi.tilebox();
+
+          auto const& Y_a = mass_frac.const_array(mfi);
+          auto const& e_a = energy.const_array(mfi);
+          auto const& rho_a = density.const_array(mfi);
+          auto const& T_a = T_fused.array(mfi);
+          auto const& s_a = state_fused.array(mfi);
+          amrex::launch(gbox, [=] AMREX_GPU_DEVICE(amrex::Box const& tbx) {
+            pele::physics::eos::recover_state<
+              pele::physics::PhysicsType::eos_type>(
+              tbx, rho_a, e_a, Y_a, T_a, amrex::Array4<amrex::Real>(s_a, 0, 1),
+              amrex::Array4<amrex::Real>(s_a, 1, 1),
+              amrex::Array4<amrex::Real>(s_a, 2, 1),
+              amrex::Array4<amrex::Real>(s_a, 3, 1),
+              amrex::Array4<amrex::Real>(s_a, 4, 1), outputs, leosparm);
+          });
+        }
+        amrex::Gpu::streamSynchronize();
+      }
+      amrex::Real fused_time = amrex::ParallelDescriptor::second() - strt_time;
+      amrex::ParallelDescriptor::ReduceRealMax(
+        fused_time, amrex::ParallelDescriptor::IOProcessorNumber());
+
+      const auto ncells = static_cast<amrex::Real>(domain.numPts());
+      amrex::Print() << " >> per-call state recovery: " << seq_time << " s, "
+                     << ncells * niter / seq_time << " cells/s\n";
+      amrex::Print() << " >> recover_state: " << fused_time << " s, "
+                     << ncells * niter / fused_time
+                     << " cells/s, speedup: " << seq_time / fused_time << "\n";
+
+      // Both paths must agree to the tolerance of the temperature inversion
+      amrex::MultiFab::Subtract(T_fused, T_seq, 0, 0, 1, num_grow);
+      amrex::MultiFab::Subtract(state_fused, state_seq, 0, 0, nstate, num_grow);
+      amrex::Print() << " >> max difference: T " << T_fused.norm0(0);
+      const amrex::Vector<std::string> state_names = {"P", "Cs", "G", "Cv",
+                                                      "Cp"};
+      for (int n = 0; n < nstate; ++n) {
+        amrex::Print() << ", " << state_names[n] << " "
+                       << state_fused.norm0(n) / (state_seq.norm0(n) + 1.e-300);
+      }
+      amrex::Print() << " (relative)\n";
+    }
+
     if (do_plot) {
       amrex::MultiFab VarPlt(ba, dm, 4 + 2 * NUM_SPECIES, num_grow);
       amrex::MultiFab::Copy(VarPlt, density, 0, 0, 1, num_grow);
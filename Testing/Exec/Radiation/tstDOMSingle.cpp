@@ -0,0 +1,146 @@
+#include <AMReX.H>
+#include <AMReX_MultiFabUtil.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMRParam.H>
+#include <DOMSingle.H>
+
+// Isothermal, uniformly absorbing cube with cold black walls. The incident
+// radiation is bounded by its blackbody value 4 sigma T^4 and reaches it in
+// the optically thick interior. The solve is repeated to time it, run with
+// increasing numbers of ranks for the strong scaling, e.g.
+//   mpiexec -n 8 PeleRad_DOMSingle.exe inputs.tstDOMSingle n_cell=128
+// The sweeps are timed with one group of directions per octant and with the
+// dom_angle_groups of the inputs, to show the gain of the pipelining
+
+void
+initMeshandData(
+  PeleRad::AMRParam const& amrpp,
+  amrex::Geometry& geom,
+  amrex::BoxArray& grids,
+  amrex::DistributionMapping& dmap,
+  amrex::MultiFab& solution,
+  amrex::MultiFab& rhs,
+  amrex::MultiFab& acoef,
+  amrex::Real const kappa,
+  amrex::Real const G_bb)
+{
+  int const n_cell = amrpp.n_cell_;
+  int const max_grid_size = amrpp.max_grid_size_;
+
+  amrex::RealBox rb(
+    {AMREX_D_DECL(-1.0, -1.0, -1.0)}, {AMREX_D_DECL(1.0, 1.0, 1.0)});
+  amrex::Array<int, AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0, 0, 0)};
+  amrex::Geometry::Setup(&rb, 0, is_periodic.data());
+  amrex::Box domain0(
+    amrex::IntVect{AMREX_D_DECL(0, 0, 0)},
+    amrex::IntVect{AMREX_D_DECL(n_cell - 1, n_cell - 1, n_cell - 1)});
+  geom.define(domain0);
+
+  grids.define(domain0);
+  grids.maxSize(max_grid_size);
+
+  dmap.define(grids);
+  solution.define(grids, dmap, 1, 0);
+  rhs.define(grids, dmap, 1, 0);
+  acoef.define(grids, dmap, 1, 0);
+
+  solution.setVal(0.0);
+  acoef.setVal(kappa);
+  rhs.setVal(kappa * G_bb);
+}
+
+// Solve nsolves times and return the time per solve, max over the ranks
+amrex::Real
+timeSolves(PeleRad::DOMSingle& rte, int const nsolves)
+{
+  rte.solve();
+  amrex::ParallelDescriptor::Barrier();
+  auto const t0 = amrex::second();
+  for (int n = 0; n < nsolves; ++n) {
+    rte.solve();
+  }
+  amrex::Real t = (amrex::second() - t0) / static_cast<amrex::Real>(nsolves);
+  amrex::ParallelDescriptor::ReduceRealMax(t);
+  return t;
+}
+
+int
+main(int argc, char* argv[])
+{
+  amrex::Initialize(argc, argv);
+  bool ok = true;
+  {
+    amrex::ParmParse pp;
+    PeleRad::AMRParam amrpp(pp);
+    PeleRad::MLMGParam mlmgpp(pp);
+
+    amrex::Real kappa = 20.0;
+    int nsolves = 3;
+    pp.query("kappa", kappa);
+    pp.query("nsolves", nsolves);
+
+    // sigma T^4 = 1
+    amrex::Real const G_bb = 4.0;
+
+    amrex::Geometry geom;
+    amrex::BoxArray grids;
+    amrex::DistributionMapping dmap;
+
+    amrex::MultiFab solution;
+    amrex::MultiFab rhs;
+    amrex::MultiFab acoef;
+
+    initMeshandData(
+      amrpp, geom, grids, dmap, solution, rhs, acoef, kappa, G_bb);
+
+    PeleRad::DOMSingle rte(mlmgpp, geom, grids, dmap, solution, rhs, acoef);
+    auto const t_pipe = timeSolves(rte, nsolves);
+    int const stages_pipe = rte.numStages();
+
+    PeleRad::MLMGParam mlmgpp_seq = mlmgpp;
+    mlmgpp_seq.dom_angle_groups_ = 1;
+    amrex::MultiFab solution_seq(grids, dmap, 1, 0);
+    PeleRad::DOMSingle rte_seq(
+      mlmgpp_seq, geom, grids, dmap, solution_seq, rhs, acoef);
+    auto const t_seq = timeSolves(rte_seq, nsolves);
+    int const stages_seq = rte_seq.numStages();
+
+    // the grouping of the directions does not change the solution
+    amrex::MultiFab::Subtract(solution_seq, solution, 0, 0, 1, 0);
+    amrex::Real const diff = solution_seq.norm0();
+
+    // bounded by the blackbody value and reaching it at the center
+    amrex::Real const G_max = solution.max(0);
+    int const n_cell = amrpp.n_cell_;
+    amrex::Box const center(
+      amrex::IntVect(n_cell / 2 - 1), amrex::IntVect(n_cell / 2));
+    amrex::Real G_center = G_bb;
+    for (amrex::MFIter mfi(solution); mfi.isValid(); ++mfi) {
+      amrex::Box const bx = mfi.validbox() & center;
+      if (bx.ok()) {
+        G_center = amrex::min(
+          G_center, solution[mfi].min<amrex::RunOn::Device>(bx, 0));
+      }
+    }
+    amrex::ParallelDescriptor::ReduceRealMin(G_center);
+
+    amrex::Print() << "S" << mlmgpp.dom_order_ << ", "
+                   << amrex::ParallelDescriptor::NProcs() << " ranks, "
+                   << grids.size() << " boxes\n"
+                   << "pipelined: " << stages_pipe << " stages, " << t_pipe
+                   << " s per solve\n"
+                   << "one group per octant: " << stages_seq << " stages, "
+                   << t_seq << " s per solve\n"
+                   << "G center " << G_center << ", G max " << G_max
+                   << ", difference between the groupings " << diff << "\n";
+
+    ok = (std::abs(G_center - G_bb) < 1e-3 * G_bb) &&
+         (G_max <= G_bb * (1.0 + 1e-12)) && (diff < 1e-12 * G_bb);
+  }
+  amrex::Finalize();
+  if (ok) {
+    return (0);
+  } else {
+    return (-1);
+  }
+}
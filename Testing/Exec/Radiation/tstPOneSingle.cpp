@@ -181,6 +181,94 @@ check_norm(amrex::MultiFab const& phi, amrex::MultiFab const& exact)
   return L1norm;
 }
 
+// Solve nbands scaled copies of the problem as the components of one solve
+// and compare its time with nbands solves of a single component
+bool
+checkBands(
+  PeleRad::AMRParam const& amrpp,
+  PeleRad::MLMGParam const& mlmgpp,
+  int const nbands)
+{
+  amrex::Geometry geom;
+  amrex::BoxArray grids;
+  amrex::DistributionMapping dmap;
+
+  amrex::MultiFab solution;
+  amrex::MultiFab rhs;
+  amrex::MultiFab exact_solution;
+
+  amrex::MultiFab acoef;
+  amrex::MultiFab bcoef;
+  amrex::MultiFab robin_a;
+  amrex::MultiFab robin_b;
+  amrex::MultiFab robin_f;
+
+  initMeshandData(
+    amrpp, geom, grids, dmap, solution, rhs, exact_solution, acoef, bcoef,
+    robin_a, robin_b, robin_f);
+
+  amrex::IntVect ng = amrex::IntVect{1};
+
+  amrex::MultiFab solution_b(grids, dmap, nbands, ng);
+  amrex::MultiFab rhs_b(grids, dmap, nbands, 0);
+  amrex::MultiFab exact_b(grids, dmap, nbands, 0);
+  amrex::MultiFab acoef_b(grids, dmap, nbands, 0);
+  amrex::MultiFab bcoef_b(grids, dmap, nbands, ng);
+  amrex::MultiFab robin_a_b(grids, dmap, nbands, ng);
+  amrex::MultiFab robin_b_b(grids, dmap, nbands, ng);
+  amrex::MultiFab robin_f_b(grids, dmap, nbands, ng);
+
+  for (int n = 0; n < nbands; ++n) {
+    amrex::Real const scale = static_cast<amrex::Real>(n + 1);
+    amrex::MultiFab::Copy(solution_b, solution, 0, n, 1, ng);
+    amrex::MultiFab::Copy(rhs_b, rhs, 0, n, 1, 0);
+    amrex::MultiFab::Copy(exact_b, exact_solution, 0, n, 1, 0);
+    amrex::MultiFab::Copy(acoef_b, acoef, 0, n, 1, 0);
+    amrex::MultiFab::Copy(bcoef_b, bcoef, 0, n, 1, ng);
+    amrex::MultiFab::Copy(robin_a_b, robin_a, 0, n, 1, ng);
+    amrex::MultiFab::Copy(robin_b_b, robin_b, 0, n, 1, ng);
+    amrex::MultiFab::Copy(robin_f_b, robin_f, 0, n, 1, ng);
+    solution_b.mult(scale, n, 1, ng);
+    rhs_b.mult(scale, n, 1, 0);
+    exact_b.mult(scale, n, 1, 0);
+    robin_f_b.mult(scale, n, 1, ng);
+  }
+
+  PeleRad::POneSingle rte_b(
+    mlmgpp, geom, grids, dmap, solution_b, rhs_b, acoef_b, bcoef_b, robin_a_b,
+    robin_b_b, robin_f_b);
+  auto t0 = amrex::second();
+  rte_b.solve();
+  auto const t_bands = amrex::second() - t0;
+
+  // the single component solves share the operator and start from zero
+  PeleRad::POneSingle rte(
+    mlmgpp, geom, grids, dmap, solution, rhs, acoef, bcoef, robin_a, robin_b,
+    robin_f);
+  t0 = amrex::second();
+  for (int n = 0; n < nbands; ++n) {
+    solution.setVal(0.0, 0, 1, 0);
+    rte.solve();
+  }
+  auto const t_single = amrex::second() - t0;
+
+  bool ok = true;
+  amrex::Real const npts = static_cast<amrex::Real>(grids.numPts());
+  for (int n = 0; n < nbands; ++n) {
+    amrex::MultiFab err(grids, dmap, 1, 0);
+    amrex::MultiFab::Copy(err, solution_b, n, 0, 1, 0);
+    amrex::MultiFab::Subtract(err, exact_b, n, 0, 1, 0);
+    amrex::Real const eps =
+      err.norm1() / (npts * static_cast<amrex::Real>(n + 1));
+    std::cout << "band " << n << ", normalized L1 norm:" << eps << std::endl;
+    ok = ok && (eps < 1e-3);
+  }
+  std::cout << nbands << " bands: one solve " << t_bands << " s ("
+            << rte_b.stats().num_iters << " iterations), " << nbands
+            << " single solves " << t_single << " s" << std::endl;
+  return ok;
+}
+
 int
 main(int argc, char* argv[])
 {
@@ -218,6 +306,17 @@ main(int argc, char* argv[])
 
   // std::cout << "solve the PDE ... \n";
   rte.solve();
+  int const cold_iters = rte.stats().num_iters;
+
+  // solve again, the operator is reused and the previous solution is the
+  // initial guess
+  rte.solve();
+  int const warm_iters = rte.stats().num_iters;
+  std::cout << "iterations: cold start " << cold_iters << ", warm start "
+            << warm_iters << ", operator builds " << rte.stats().num_builds
+            << std::endl;
+  bool const reuse_ok =
+    (rte.stats().num_builds == 1 && warm_iters <= cold_iters);
 
   auto eps = check_norm(solution, exact_solution);
   eps /= static_cast<amrex::Real>(n_cell * n_cell * n_cell);
@@ -248,8 +347,12 @@ main(int argc, char* argv[])
     */
   }
 
+  int nbands = 1;
+  pp.query("nbands", nbands);
+  bool const bands_ok = (nbands <= 1 || checkBands(amrpp, mlmgpp, nbands));
+
   amrex::Finalize();
-  if (eps < 1e-3) {
+  if (eps < 1e-3 && reuse_ok && bands_ok) {
     return (0);
   } else {
     return (-1);
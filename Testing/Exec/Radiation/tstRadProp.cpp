@@ -0,0 +1,389 @@
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Reduce.H>
+#include <AMRParam.H>
+#include <PeleLMRad.H>
+
+// Radiative properties of PeleLMRad, evaluated in a single pass per box,
+// against the separate passes they replace: the absorption coefficient, then
+// the coefficients and the Robin data over the grown box with std::pow. Both
+// are timed over nrep evaluations and the coefficients, their values on the
+// ghost cells of the Robin BC and the incident radiation are compared
+
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
+initGasField(
+  int i,
+  int j,
+  int k,
+  amrex::Array4<amrex::Real> const& y_co2,
+  amrex::Array4<amrex::Real> const& y_h2o,
+  amrex::Array4<amrex::Real> const& y_co,
+  amrex::Array4<amrex::Real> const& temp,
+  amrex::Array4<amrex::Real> const& pressure,
+  amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> const& dx,
+  amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> const& plo,
+  amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> const& phi)
+{
+  amrex::IntVect const iv(AMREX_D_DECL(i, j, k));
+  amrex::Real r2 = 0.0;
+  for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+    amrex::Real const xc = (phi[idim] + plo[idim]) * 0.5;
+    amrex::Real const x = plo[idim] + (iv[idim] + 0.5) * dx[idim];
+    r2 += (x - xc) * (x - xc);
+  }
+  amrex::Real const expr = std::exp(-r2 / 0.1);
+
+  temp(i, j, k) = 300.0 + 1700.0 * expr;
+  pressure(i, j, k) = 1.0e5; // Pa
+  y_co2(i, j, k) = 0.1 * expr;
+  y_h2o(i, j, k) = 0.2 * expr;
+  y_co(i, j, k) = 0.09 * expr;
+}
+
+// Radiation::updateSpecProp as it was before the single pass, copied from
+// the baseline, gray gas without soot
+void
+updateSpecPropRef(
+  amrex::Geometry const& geom,
+  amrex::MFIter const& mfi,
+  PeleRad::PlanckMean const& radprop,
+  amrex::Array4<const amrex::Real> const& Yco2,
+  amrex::Array4<const amrex::Real> const& Yh2o,
+  amrex::Array4<const amrex::Real> const& Yco,
+  amrex::Array4<const amrex::Real> const& T,
+  amrex::Array4<const amrex::Real> const& P,
+  amrex::Array4<amrex::Real> const& kappa,
+  amrex::Array4<amrex::Real> const& rhsfab,
+  amrex::Array4<amrex::Real> const& alphafab,
+  amrex::Array4<amrex::Real> const& betafab,
+  amrex::Array4<amrex::Real> const& robin_a_fab,
+  amrex::Array4<amrex::Real> const& robin_b_fab,
+  amrex::Array4<amrex::Real> const& robin_f_fab)
+{
+  auto const& kpco2 = radprop.kpco2();
+  auto const& kph2o = radprop.kph2o();
+  auto const& kpco = radprop.kpco();
+
+  amrex::Box const& bx = mfi.validbox();
+  amrex::Box const& gbx = amrex::grow(bx, 1);
+
+  auto const dlo = amrex::lbound(geom.Domain());
+  auto const dhi = amrex::ubound(geom.Domain());
+
+  amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+    PeleRad::RadProp::getRadPropGas(
+      i, j, k, Yco2, Yh2o, Yco, T, P, kappa, kpco2, kph2o, kpco);
+  });
+
+  amrex::ParallelFor(gbx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+    betafab(i, j, k) = 1.0;
+
+    if (bx.contains(i, j, k)) {
+      double ka = std::max(0.01, kappa(i, j, k) * 100);
+      betafab(i, j, k) = 1.0 / ka;
+
+      rhsfab(i, j, k) = 4.0 * ka * 5.67e-8 * std::pow(T(i, j, k),
+                                                      4.0); // SI
+
+      /*rhsfab(i, j, k) = 4.0 * ka * 5.67e-5
+                        * std::pow(T(i, j, k),
+                            4.0);*/ // cgs
+      alphafab(i, j, k) = ka;
+    }
+
+    // Robin BC
+    bool robin_cell = false;
+    if (j >= dlo.y && j <= dhi.y && k >= dlo.z && k <= dhi.z) {
+      int jj, kk;
+
+      if (j < bx.loVect3d()[1]) {
+        jj = bx.loVect3d()[1];
+      } else if (j > bx.hiVect3d()[1]) {
+        jj = bx.hiVect3d()[1];
+      } else {
+        jj = j;
+      }
+      if (k < bx.loVect3d()[2]) {
+        kk = bx.loVect3d()[2];
+      } else if (k > bx.hiVect3d()[2]) {
+        kk = bx.hiVect3d()[2];
+      } else {
+        kk = k;
+      }
+
+      if (i > dhi.x) {
+        robin_cell = true;
+        betafab(i, j, k) = 1.0 / std::max(1.0, kappa(dhi.x, jj, kk) * 100);
+      }
+      if (i < dlo.x) {
+        robin_cell = true;
+        betafab(i, j, k) = 1.0 / std::max(1.0, kappa(dlo.x, jj, kk) * 100);
+      }
+    } else if (i >= dlo.x && i <= dhi.x && k >= dlo.z && k <= dhi.z) {
+      int ii, kk;
+
+      if (i < bx.loVect3d()[0]) {
+        ii = bx.loVect3d()[0];
+      } else if (i > bx.hiVect3d()[0]) {
+        ii = bx.hiVect3d()[0];
+      } else {
+        ii = i;
+      }
+      if (k < bx.loVect3d()[2]) {
+        kk = bx.loVect3d()[2];
+      } else if (k > bx.hiVect3d()[2]) {
+        kk = bx.hiVect3d()[2];
+      } else {
+        kk = k;
+      }
+
+      if (j > dhi.y) {
+        robin_cell = true;
+        betafab(i, j, k) = 1.0 / std::max(1.0, kappa(ii, dhi.y, kk) * 100);
+      }
+      if (j < dlo.y) {
+        robin_cell = true;
+        betafab(i, j, k) = 1.0 / std::max(1.0, kappa(ii, dlo.y, kk) * 100);
+      }
+    } else if (i >= dlo.x && i <= dhi.x && j >= dlo.y && j <= dhi.y) {
+      int ii, jj;
+
+      if (i < bx.loVect3d()[0]) {
+        ii = bx.loVect3d()[0];
+      } else if (i > bx.hiVect3d()[0]) {
+        ii = bx.hiVect3d()[0];
+      } else {
+        ii = i;
+      }
+      if (j < bx.loVect3d()[1]) {
+        jj = bx.loVect3d()[1];
+      } else if (j > bx.hiVect3d()[1]) {
+        jj = bx.hiVect3d()[1];
+      } else {
+        jj = j;
+      }
+
+      if (k > dhi.z) {
+        robin_cell = true;
+        betafab(i, j, k) = 1.0 / std::max(1.0, kappa(ii, jj, dhi.z) * 100);
+      }
+      if (k < dlo.z) {
+        robin_cell = true;
+        betafab(i, j, k) = 1.0 / std::max(1.0, kappa(ii, jj, dlo.z) * 100);
+      }
+    }
+
+    if (robin_cell) {
+      robin_a_fab(i, j, k) = -1.0 / betafab(i, j, k);
+      robin_b_fab(i, j, k) = -2.0 / 3.0;
+      robin_f_fab(i, j, k) = 0.0;
+    }
+  });
+}
+
+// Time per call of f, max over the ranks
+template <typename F>
+amrex::Real
+timeEvals(F const& f, int const nrep)
+{
+  f();
+  amrex::Gpu::streamSynchronize();
+  amrex::ParallelDescriptor::Barrier();
+  auto const t0 = amrex::second();
+  for (int n = 0; n < nrep; ++n) {
+    f();
+  }
+  amrex::Gpu::streamSynchronize();
+  amrex::Real t = (amrex::second() - t0) / static_cast<amrex::Real>(nrep);
+  amrex::ParallelDescriptor::ReduceRealMax(t);
+  return t;
+}
+
+// Max of |a - b| over max of |b|
+amrex::Real
+relDiff(amrex::MultiFab const& a, amrex::MultiFab const& b)
+{
+  amrex::MultiFab d(a.boxArray(), a.DistributionMap(), 1, 0);
+  amrex::MultiFab::Copy(d, a, 0, 0, 1, 0);
+  amrex::MultiFab::Subtract(d, b, 0, 0, 1, 0);
+  amrex::Real const bmax = b.norm0();
+  return (bmax > 0.0) ? d.norm0() / bmax : d.norm0();
+}
+
+// Max of |a - b| over |b| on the ghost cells outside of the domain facing a
+// valid cell, where the operator reads the Robin BC
+amrex::Real
+ghostRelDiff(
+  amrex::Geometry const& geom,
+  amrex::MultiFab const& a,
+  amrex::MultiFab const& b)
+{
+  amrex::IntVect const dlo = geom.Domain().smallEnd();
+  amrex::IntVect const dhi = geom.Domain().bigEnd();
+
+  amrex::ReduceOps<amrex::ReduceOpMax> reduce_op;
+  amrex::ReduceData<amrex::Real> reduce_data(reduce_op);
+  using ReduceTuple = typename decltype(reduce_data)::Type;
+  for (amrex::MFIter mfi(a); mfi.isValid(); ++mfi) {
+    auto const& af = a.const_array(mfi);
+    auto const& bf = b.const_array(mfi);
+    reduce_op.eval(
+      mfi.validbox(), reduce_data,
+      [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept -> ReduceTuple {
+        amrex::IntVect const iv(AMREX_D_DECL(i, j, k));
+        amrex::Real d = 0.0;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+          auto const e = amrex::IntVect::TheDimensionVector(idim);
+          if (iv[idim] == dlo[idim]) {
+            d = amrex::max(
+              d, std::abs(af(iv - e) - bf(iv - e)) / std::abs(bf(iv - e)));
+          }
+          if (iv[idim] == dhi[idim]) {
+            d = amrex::max(
+              d, std::abs(af(iv + e) - bf(iv + e)) / std::abs(bf(iv + e)));
+          }
+        }
+        return {d};
+      });
+  }
+  amrex::Real d = amrex::get<0>(reduce_data.value(reduce_op));
+  amrex::ParallelDescriptor::ReduceRealMax(d);
+  return d;
+}
+
+int
+main(int argc, char* argv[])
+{
+  amrex::Initialize(argc, argv);
+  bool ok = true;
+  {
+    amrex::ParmParse pp;
+    PeleRad::AMRParam amrpp(pp);
+    PeleRad::MLMGParam mlmgpp(pp);
+
+    int nrep = 10;
+    pp.query("nrep", nrep);
+
+    int const n_cell = amrpp.n_cell_;
+    int const max_grid_size = amrpp.max_grid_size_;
+
+    amrex::Vector<amrex::Geometry> geom(1);
+    amrex::Vector<amrex::BoxArray> grids(1);
+    amrex::Vector<amrex::DistributionMapping> dmap(1);
+
+    amrex::RealBox rb(
+      {AMREX_D_DECL(0.0, 0.0, 0.0)}, {AMREX_D_DECL(1.0, 1.0, 1.0)});
+    amrex::Array<int, AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(0, 0, 0)};
+    amrex::Geometry::Setup(&rb, 0, is_periodic.data());
+    amrex::Box domain0(
+      amrex::IntVect{AMREX_D_DECL(0, 0, 0)},
+      amrex::IntVect{AMREX_D_DECL(n_cell - 1, n_cell - 1, n_cell - 1)});
+    geom[0].define(domain0);
+    grids[0].define(domain0);
+    grids[0].maxSize(max_grid_size);
+    dmap[0].define(grids[0]);
+
+    amrex::MultiFab y_co2(grids[0], dmap[0], 1, 0);
+    amrex::MultiFab y_h2o(grids[0], dmap[0], 1, 0);
+    amrex::MultiFab y_co(grids[0], dmap[0], 1, 0);
+    amrex::MultiFab temperature(grids[0], dmap[0], 1, 0);
+    amrex::MultiFab pressure(grids[0], dmap[0], 1, 0);
+
+    auto const plo = geom[0].ProbLoArray();
+    auto const phi = geom[0].ProbHiArray();
+    auto const dx = geom[0].CellSizeArray();
+    for (amrex::MFIter mfi(temperature); mfi.isValid(); ++mfi) {
+      auto const& Yco2 = y_co2.array(mfi);
+      auto const& Yh2o = y_h2o.array(mfi);
+      auto const& Yco = y_co.array(mfi);
+      auto const& T = temperature.array(mfi);
+      auto const& P = pressure.array(mfi);
+      amrex::ParallelFor(
+        mfi.validbox(), [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+          initGasField(i, j, k, Yco2, Yh2o, Yco, T, P, dx, plo, phi);
+        });
+    }
+
+    PeleRad::RadComps rc;
+    PeleRad::Radiation rad(geom, grids, dmap, rc, pp);
+
+    auto fused = [&]() {
+      for (amrex::MFIter mfi(temperature); mfi.isValid(); ++mfi) {
+        rad.updateSpecProp(
+          mfi, y_co2.const_array(mfi), y_h2o.const_array(mfi),
+          y_co.const_array(mfi), temperature.const_array(mfi),
+          pressure.const_array(mfi), 0);
+      }
+    };
+
+    amrex::IntVect ng = amrex::IntVect{1};
+    amrex::Vector<amrex::MultiFab> solution(1);
+    amrex::Vector<amrex::MultiFab> rhs(1);
+    amrex::Vector<amrex::MultiFab> acoef(1);
+    amrex::Vector<amrex::MultiFab> bcoef(1);
+    amrex::Vector<amrex::MultiFab> robin_a(1);
+    amrex::Vector<amrex::MultiFab> robin_b(1);
+    amrex::Vector<amrex::MultiFab> robin_f(1);
+    amrex::MultiFab absc(grids[0], dmap[0], 1, 0);
+    solution[0].define(grids[0], dmap[0], 1, ng);
+    rhs[0].define(grids[0], dmap[0], 1, 0);
+    acoef[0].define(grids[0], dmap[0], 1, 0);
+    bcoef[0].define(grids[0], dmap[0], 1, ng);
+    robin_a[0].define(grids[0], dmap[0], 1, ng);
+    robin_b[0].define(grids[0], dmap[0], 1, ng);
+    robin_f[0].define(grids[0], dmap[0], 1, ng);
+    solution[0].setVal(0.0, 0, 1, ng);
+
+    PeleRad::PlanckMean radprop(mlmgpp.kppath_);
+    auto separate = [&]() {
+      for (amrex::MFIter mfi(temperature); mfi.isValid(); ++mfi) {
+        updateSpecPropRef(
+          geom[0], mfi, radprop, y_co2.const_array(mfi),
+          y_h2o.const_array(mfi), y_co.const_array(mfi),
+          temperature.const_array(mfi), pressure.const_array(mfi),
+          absc.array(mfi), rhs[0].array(mfi), acoef[0].array(mfi),
+          bcoef[0].array(mfi), robin_a[0].array(mfi), robin_b[0].array(mfi),
+          robin_f[0].array(mfi));
+      }
+    };
+
+    auto const t_fused = timeEvals(fused, nrep);
+    auto const t_sep = timeEvals(separate, nrep);
+
+    amrex::Real const diff_emis = relDiff(rad.emis()[0], rhs[0]);
+    amrex::Real const diff_kappa = relDiff(rad.kappa()[0], acoef[0]);
+    amrex::Real const diff_bcoef =
+      ghostRelDiff(geom[0], rad.bcoef()[0], bcoef[0]);
+    amrex::Real const diff_robin =
+      ghostRelDiff(geom[0], rad.robinA()[0], robin_a[0]);
+
+    // Same solve with both sets of coefficients
+    rad.evaluateRad();
+    bcoef[0].FillBoundary();
+    PeleRad::POneMulti rte(
+      mlmgpp, geom, grids, dmap, solution, rhs, acoef, bcoef, robin_a,
+      robin_b, robin_f);
+    rte.solve();
+    amrex::Real const diff_G = relDiff(rad.G()[0], solution[0]);
+
+    amrex::Print() << amrex::ParallelDescriptor::NProcs() << " ranks, "
+                   << grids[0].size() << " boxes of up to " << max_grid_size
+                   << " cells\n"
+                   << "fused: " << t_fused << " s per evaluation\n"
+                   << "separate passes: " << t_sep << " s per evaluation\n"
+                   << "relative differences: emission " << diff_emis
+                   << ", kappa " << diff_kappa << ", boundary bcoef "
+                   << diff_bcoef << ", boundary robin_a " << diff_robin
+                   << ", G " << diff_G << "\n";
+
+    ok = (diff_emis < 1e-12) && (diff_kappa < 1e-12) &&
+         (diff_bcoef < 1e-12) && (diff_robin < 1e-12) &&
+         (diff_G < mlmgpp.reltol_);
+  }
+  amrex::Finalize();
+  if (ok) {
+    return (0);
+  } else {
+    return (-1);
+  }
+}
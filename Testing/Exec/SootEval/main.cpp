@@ -0,0 +1,436 @@
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#ifdef AMREX_USE_OMP
+#include <omp.h>
+#endif
+
+#include "mechanism.H"
+#include <GPU_misc.H>
+
+#include <PelePhysics.H>
+#include <ReactorBase.H>
+#include "SootModel.H"
+
+// Max over the cells of the difference between a and b in component comp,
+// relative to the max change of b from a0
+amrex::Real
+relDiff(
+  const amrex::MultiFab& a,
+  const amrex::MultiFab& b,
+  const amrex::MultiFab& a0,
+  const int comp)
+{
+  amrex::MultiFab d(a.boxArray(), a.DistributionMap(), 1, 0);
+  amrex::MultiFab db(a.boxArray(), a.DistributionMap(), 1, 0);
+  amrex::MultiFab::Copy(d, a, comp, 0, 1, 0);
+  amrex::MultiFab::Subtract(d, b, comp, 0, 1, 0);
+  amrex::MultiFab::Copy(db, b, comp, 0, 1, 0);
+  amrex::MultiFab::Subtract(db, a0, comp, 0, 1, 0);
+  const amrex::Real ref = db.norm0();
+  return (ref > 0.) ? d.norm0() / ref : d.norm0();
+}
+
+// Integrate the soot together with the chemistry of an e reactor over
+// react_dt with react_soot, then nsplit Strang steps of the soot source term
+// (half step), the chemistry and the soot source term (half step) from the
+// same state. The temperature, the moments and the soot gas species must
+// agree within react_tol, relative to their change over the step
+void
+checkReactSoot(
+  const SootModel& soot_model,
+  const SootComps& comps,
+  const amrex::MultiFab& state,
+  const amrex::MultiFab& mu)
+{
+  amrex::ParmParse pp;
+  std::string chem_integrator = "ReactorRK64";
+  pp.query("chem_integrator", chem_integrator);
+  amrex::Real react_dt = 1.E-5;
+  pp.query("react_dt", react_dt);
+  int nsplit = 50;
+  pp.query("nsplit", nsplit);
+  amrex::Real react_tol = 1.E-2;
+  pp.query("react_tol", react_tol);
+
+  const auto& ba = state.boxArray();
+  const auto& dm = state.DistributionMap();
+  int max_cells = 0;
+  for (int n = 0; n < ba.size(); ++n) {
+    max_cells = amrex::max(max_cells, static_cast<int>(ba[n].numPts()));
+  }
+  std::unique_ptr<pele::physics::reactions::ReactorBase> reactor =
+    pele::physics::reactions::ReactorBase::create(chem_integrator);
+  reactor->init(1, max_cells);
+  const SootODEData sod = soot_model.getODEData();
+  const SootData* sd = soot_model.getSootData_d();
+
+  // Gas state rho Y, T, rho E and the moments, the initial state in the
+  // last components
+  const int nsoot = NUM_SOOT_MOMENTS + 1;
+  const int iT = NUM_SPECIES;
+  const int iE = NUM_SPECIES + 1;
+  const int iS = NUM_SPECIES + 2;
+  const int nvar = NUM_SPECIES + 2 + nsoot;
+  amrex::MultiFab coupled(ba, dm, nvar, 0);
+  amrex::MultiFab split(ba, dm, nvar, 0);
+  amrex::MultiFab init(ba, dm, nvar, 0);
+  amrex::MultiFab ext_src(ba, dm, nvar, 0);
+  amrex::MultiFab fc(ba, dm, 1, 0);
+  amrex::iMultiFab mask(ba, dm, 1, 0);
+  amrex::MultiFab q(ba, dm, state.nComp(), 0);
+  amrex::MultiFab src(ba, dm, state.nComp(), 0);
+  ext_src.setVal(0.);
+  mask.setVal(1);
+  for (amrex::MFIter mfi(init); mfi.isValid(); ++mfi) {
+    const amrex::Box& bx = mfi.validbox();
+    auto const& s = state.const_array(mfi);
+    auto const& u = init.array(mfi);
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      auto eos = pele::physics::PhysicsType::eos();
+      const amrex::Real rho = s(i, j, k, comps.qRhoIndx);
+      const amrex::Real T = s(i, j, k, comps.qTempIndx);
+      amrex::Real Y[NUM_SPECIES];
+      for (int n = 0; n < NUM_SPECIES; ++n) {
+        Y[n] = s(i, j, k, comps.qSpecIndx + n);
+        u(i, j, k, n) = rho * Y[n];
+      }
+      amrex::Real e = 0.;
+      eos.TY2E(T, Y, e);
+      u(i, j, k, iT) = T;
+      u(i, j, k, iE) = rho * e;
+      for (int n = 0; n < nsoot; ++n) {
+        u(i, j, k, iS + n) = s(i, j, k, comps.qSootIndx + n);
+      }
+    });
+  }
+  amrex::MultiFab::Copy(coupled, init, 0, 0, nvar, 0);
+  amrex::MultiFab::Copy(split, init, 0, 0, nvar, 0);
+
+  amrex::Real strt_time = amrex::ParallelDescriptor::second();
+  for (amrex::MFIter mfi(coupled); mfi.isValid(); ++mfi) {
+    const amrex::Box& bx = mfi.validbox();
+    auto const& u = coupled.array(mfi);
+    auto const& f = ext_src.array(mfi);
+    amrex::Real dt_react = react_dt;
+    amrex::Real time = 0.;
+    reactor->react_soot(
+      bx, amrex::Array4<amrex::Real>(u, 0, NUM_SPECIES),
+      amrex::Array4<amrex::Real>(f, 0, NUM_SPECIES),
+      amrex::Array4<amrex::Real>(u, iT, 1),
+      amrex::Array4<amrex::Real>(u, iE, 1),
+      amrex::Array4<amrex::Real>(f, iE, 1), fc.array(mfi), mask.array(mfi),
+      amrex::Array4<amrex::Real>(u, iS, nsoot),
+      amrex::Array4<const amrex::Real>(f, iS, nsoot), mu.const_array(mfi), sod,
+      dt_react, time);
+  }
+  amrex::Real coupled_time = amrex::ParallelDescriptor::second() - strt_time;
+
+  // Soot sources of the primitive state over hs, with the internal energy
+  // source, added to the gas and the moments
+  auto sootStep = [&](const amrex::Real hs) {
+    src.setVal(0.);
+    for (amrex::MFIter mfi(split); mfi.isValid(); ++mfi) {
+      const amrex::Box& bx = mfi.validbox();
+      auto const& u = split.array(mfi);
+      auto const& qa = q.array(mfi);
+      amrex::ParallelFor(
+        bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+          amrex::Real rho = 0.;
+          for (int n = 0; n < NUM_SPECIES; ++n) {
+            rho += u(i, j, k, n);
+          }
+          qa(i, j, k, comps.qRhoIndx) = rho;
+          qa(i, j, k, comps.qTempIndx) = u(i, j, k, iT);
+          for (int n = 0; n < NUM_SPECIES; ++n) {
+            qa(i, j, k, comps.qSpecIndx + n) = u(i, j, k, n) / rho;
+          }
+          for (int n = 0; n < nsoot; ++n) {
+            qa(i, j, k, comps.qSootIndx + n) = u(i, j, k, iS + n);
+          }
+        });
+      auto const& sa = src.array(mfi);
+      soot_model.computeSootSourceTerm(
+        bx, q.const_array(mfi), mu.const_array(mfi), sa, 0., hs, true,
+        nullptr);
+      amrex::ParallelFor(
+        bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+          for (int n = 0; n < NUM_SPECIES; ++n) {
+            u(i, j, k, n) += hs * sa(i, j, k, comps.specIndx + n);
+          }
+          u(i, j, k, iE) += hs * sa(i, j, k, comps.engIndx);
+          for (int n = 0; n < nsoot; ++n) {
+            u(i, j, k, iS + n) += hs * sa(i, j, k, comps.sootIndx + n);
+          }
+        });
+    }
+  };
+  const amrex::Real h = react_dt / nsplit;
+  strt_time = amrex::ParallelDescriptor::second();
+  for (int step = 0; step < nsplit; ++step) {
+    sootStep(0.5 * h);
+    for (amrex::MFIter mfi(split); mfi.isValid(); ++mfi) {
+      const amrex::Box& bx = mfi.validbox();
+      auto const& u = split.array(mfi);
+      auto const& f = ext_src.array(mfi);
+      amrex::Real dt_react = h;
+      amrex::Real time = step * h;
+      reactor->react(
+        bx, amrex::Array4<amrex::Real>(u, 0, NUM_SPECIES),
+        amrex::Array4<amrex::Real>(f, 0, NUM_SPECIES),
+        amrex::Array4<amrex::Real>(u, iT, 1),
+        amrex::Array4<amrex::Real>(u, iE, 1),
+        amrex::Array4<amrex::Real>(f, iE, 1), fc.array(mfi), mask.array(mfi),
+        dt_react, time);
+    }
+    sootStep(0.5 * h);
+  }
+  amrex::Real split_time = amrex::ParallelDescriptor::second() - strt_time;
+  amrex::ParallelDescriptor::ReduceRealMax(coupled_time);
+  amrex::ParallelDescriptor::ReduceRealMax(split_time);
+
+  // Temperature of the final energy of the split integration
+  for (amrex::MFIter mfi(split); mfi.isValid(); ++mfi) {
+    const amrex::Box& bx = mfi.validbox();
+    auto const& u = split.array(mfi);
+    amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+      auto eos = pele::physics::PhysicsType::eos();
+      amrex::Real rY[NUM_SPECIES];
+      for (int n = 0; n < NUM_SPECIES; ++n) {
+        rY[n] = u(i, j, k, n);
+      }
+      amrex::Real rho = 0., rho_inv = 0.;
+      amrex::Real Y[NUM_SPECIES];
+      eos.RY2RRinvY(rY, rho, rho_inv, Y);
+      amrex::Real T = u(i, j, k, iT);
+      eos.REY2T(rho, u(i, j, k, iE) * rho_inv, Y, T);
+      u(i, j, k, iT) = T;
+    });
+  }
+
+  amrex::Real diff_T = relDiff(coupled, split, init, iT);
+  amrex::Real diff_mom = 0.;
+  for (int n = 0; n < nsoot; ++n) {
+    diff_mom = amrex::max(diff_mom, relDiff(coupled, split, init, iS + n));
+  }
+  amrex::Real diff_gas = 0.;
+  for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+    diff_gas = amrex::max(
+      diff_gas, relDiff(
+                  coupled, split, init, soot_model.getSootData()->refIndx[sp]));
+  }
+  amrex::Print() << " >> " << chem_integrator << " react_soot: "
+                 << coupled_time << " s, " << nsplit
+                 << " split steps: " << split_time
+                 << " s\n    relative differences: T " << diff_T
+                 << ", moments " << diff_mom << ", soot gas species "
+                 << diff_gas << "\n";
+  if (diff_T > react_tol || diff_mom > react_tol || diff_gas > react_tol) {
+    amrex::Abort("react_soot differs from the split integration");
+  }
+  reactor->close();
+}
+
+int
+main(int argc, char* argv[])
+{
+  amrex::Initialize(argc, argv);
+  {
+    pele::physics::PeleParams<
+      pele::physics::eos::EosParm<pele::physics::PhysicsType::eos_type>>
+      eos_parms;
+    eos_parms.initialize();
+
+    amrex::ParmParse pp;
+
+    int gridsize = 64;
+    pp.query("gridsize", gridsize);
+    int nsteps = 10;
+    pp.query("nsteps", nsteps);
+    amrex::Real dt = 1.E-5;
+    pp.query("dt", dt);
+    amrex::Vector<int> omp_threads;
+    pp.queryarr("omp_threads", omp_threads);
+
+    // Define geometry
+    amrex::Array<int, AMREX_SPACEDIM> npts{AMREX_D_DECL(1, 1, 1)};
+    for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+      npts[i] = gridsize;
+    }
+
+    amrex::Box domain(
+      amrex::IntVect(AMREX_D_DECL(0, 0, 0)),
+      amrex::IntVect(AMREX_D_DECL(npts[0] - 1, npts[1] - 1, npts[2] - 1)));
+
+    amrex::RealBox real_box(
+      {AMREX_D_DECL(0.0, 0.0, 0.0)}, {AMREX_D_DECL(1.0, 1.0, 1.0)});
+
+    int coord = 0;
+
+    amrex::Array<int, AMREX_SPACEDIM> is_periodic{AMREX_D_DECL(1, 1, 1)};
+
+    amrex::Geometry geom(domain, real_box, coord, is_periodic);
+
+    // Define BoxArray
+    int max_size = 32;
+    pp.query("max_size", max_size);
+    amrex::BoxArray ba(domain);
+    ba.maxSize(max_size);
+
+    amrex::DistributionMapping dm{ba};
+    int num_grow = 0;
+
+    // The primitive state is rho, T, Y and the moments, the sources are
+    // rho, rho E, rho Y and the moments
+    SootComps comps;
+    comps.qRhoIndx = 0;
+    comps.qTempIndx = 1;
+    comps.qSpecIndx = 2;
+    comps.qSootIndx = 2 + NUM_SPECIES;
+    comps.rhoIndx = 0;
+    comps.engIndx = 1;
+    comps.specIndx = 2;
+    comps.sootIndx = 2 + NUM_SPECIES;
+    const int ncomp = 2 + NUM_SPECIES + NUM_SOOT_MOMENTS + 1;
+
+    SootModel soot_model;
+    soot_model.setIndices(comps);
+    soot_model.readSootParams();
+    soot_model.define();
+    const SootData* sd = soot_model.getSootData_d();
+
+    // Data MFs
+    amrex::MultiFab state(ba, dm, ncomp, num_grow);
+    amrex::MultiFab mu(ba, dm, 1, num_grow);
+    amrex::MultiFab source(ba, dm, ncomp, num_grow);
+
+    const auto geomdata = geom.data();
+    {
+      BL_PROFILE("Pele::init()");
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+      for (amrex::MFIter mfi(state, amrex::TilingIfNotGPU()); mfi.isValid();
+           ++mfi) {
+        const amrex::Box& bx = mfi.tilebox();
+        auto const& state_a = state.array(mfi);
+        auto const& mu_a = mu.array(mfi);
+        amrex::ParallelFor(
+          bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+            initialize_data(i, j, k, state_a, mu_a, comps, sd, geomdata);
+          });
+      }
+    }
+
+#ifdef AMREX_USE_OMP
+    if (omp_threads.empty()) {
+      omp_threads.push_back(omp_get_max_threads());
+    }
+#else
+    omp_threads.assign(1, 1);
+#endif
+
+    // Time nsteps source term evaluations of the same state for each thread
+    // count. The sources are reset for each count, so the checksums must
+    // not depend on the number of threads. The speedup is relative to the
+    // first thread count times its number of threads
+    const auto ncells = static_cast<amrex::Real>(domain.numPts());
+    amrex::Real ref_time = 0.;
+    for (const int nthreads : omp_threads) {
+#ifdef AMREX_USE_OMP
+      omp_set_num_threads(nthreads);
+#endif
+      source.setVal(0.);
+      SootSrcStats stats;
+      amrex::Real strt_time = amrex::ParallelDescriptor::second();
+      for (int step = 0; step < nsteps; ++step) {
+        BL_PROFILE("Pele::computeSootSourceTerm()");
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        {
+          SootSrcStats thread_stats;
+          for (amrex::MFIter mfi(state, amrex::TilingIfNotGPU());
+               mfi.isValid(); ++mfi) {
+            const amrex::Box& bx = mfi.tilebox();
+            soot_model.computeSootSourceTerm(
+              bx, state.const_array(mfi), mu.const_array(mfi),
+              source.array(mfi), 0., dt, true, &thread_stats);
+          }
+#ifdef AMREX_USE_OMP
+#pragma omp critical(soot_eval_stats)
+#endif
+          {
+            stats.num_box_cells += thread_stats.num_box_cells;
+            stats.num_cells += thread_stats.num_cells;
+            stats.num_evals += thread_stats.num_evals;
+            stats.num_fallbacks += thread_stats.num_fallbacks;
+          }
+        }
+      }
+      amrex::Real run_time = amrex::ParallelDescriptor::second() - strt_time;
+      amrex::ParallelDescriptor::ReduceRealMax(
+        run_time, amrex::ParallelDescriptor::IOProcessorNumber());
+      soot_model.reportSrcStats(stats);
+      amrex::Long counts[4] = {
+        stats.num_box_cells, stats.num_cells, stats.num_evals,
+        stats.num_fallbacks};
+      amrex::ParallelDescriptor::ReduceLongSum(
+        counts, 4, amrex::ParallelDescriptor::IOProcessorNumber());
+      stats.num_box_cells = counts[0];
+      stats.num_cells = counts[1];
+      stats.num_evals = counts[2];
+      stats.num_fallbacks = counts[3];
+      if (ref_time == 0.) {
+        ref_time = run_time * nthreads;
+      }
+      // Checksum of the sources of density, energy, the soot gas species
+      // and the moments
+      amrex::Real checksum = source.norm1(comps.rhoIndx);
+      checksum += source.norm1(comps.engIndx);
+      for (int sp = 0; sp < NUM_SOOT_GS; ++sp) {
+        checksum += source.norm1(
+          comps.specIndx + soot_model.getSootData()->refIndx[sp]);
+      }
+      for (int mom = 0; mom < NUM_SOOT_MOMENTS + 1; ++mom) {
+        checksum += source.norm1(comps.sootIndx + mom);
+      }
+      const auto num_cells = static_cast<amrex::Real>(
+        amrex::max(stats.num_cells, static_cast<amrex::Long>(1)));
+      amrex::Print() << " >> computeSootSourceTerm with " << nthreads
+                     << " threads: " << run_time << " s, "
+                     << ncells * nsteps / run_time << " cells/s, speedup "
+                     << ref_time / run_time << ", efficiency "
+                     << ref_time / (run_time * nthreads) << "\n"
+                     << "    " << stats.num_cells / nsteps
+                     << " active cells (fraction "
+                     << static_cast<amrex::Real>(stats.num_cells) /
+                          static_cast<amrex::Real>(amrex::max(
+                            stats.num_box_cells, static_cast<amrex::Long>(1)))
+                     << "), "
+                     << static_cast<amrex::Real>(stats.num_evals) / num_cells
+                     << " source evaluations per cell, "
+                     << stats.num_fallbacks << " implicit fallbacks, checksum "
+                     << std::setprecision(15) << checksum
+                     << std::setprecision(6) << "\n";
+    }
+
+    int check_react_soot = 0;
+    pp.query("check_react_soot", check_react_soot);
+    if (check_react_soot != 0) {
+      checkReactSoot(soot_model, comps, state, mu);
+    }
+
+    soot_model.cleanup();
+    eos_parms.deallocate();
+  }
+
+  amrex::Finalize();
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include "SprayParticles.H"
+#include "SprayInjection.H"
+
+using namespace amrex;
+
+bool
+SprayParticleContainer::injectParticles(
+  Real /*time*/,
+  Real /*dt*/,
+  int /*nstep*/,
+  int /*lev*/,
+  int /*finest_level*/)
+{
+  return false;
+}
+
+// Uniformly distributed parcels. The velocity and diameter of each parcel
+// are perturbed by up to part_vel_fluct and part_dia_fluct (relative) with
+// random numbers drawn from the parcel id, so that the parcels have relative
+// velocities and different sizes
+void
+SprayParticleContainer::InitSprayParticles(const bool init_parts)
+{
+  if (!init_parts) {
+    return;
+  }
+  ParmParse pp;
+  IntVect num_part(AMREX_D_DECL(64, 64, 64));
+  Vector<int> np_in;
+  if (pp.queryarr("num_part", np_in)) {
+    num_part = IntVect(AMREX_D_DECL(np_in[0], np_in[1], np_in[2]));
+  }
+  Vector<Real> vel_in(AMREX_SPACEDIM, 0.);
+  pp.queryarr("part_vel", vel_in);
+  const RealVect vel_part(AMREX_D_DECL(vel_in[0], vel_in[1], vel_in[2]));
+  Real dia_part = 50.E-4;
+  pp.query("part_dia", dia_part);
+  Real T_part = 300.;
+  pp.query("part_temp", T_part);
+  Real num_ppp = 1.;
+  pp.query("num_ppp", num_ppp);
+  Real vel_fluct = 0.;
+  pp.query("part_vel_fluct", vel_fluct);
+  Real dia_fluct = 0.;
+  pp.query("part_dia_fluct", dia_fluct);
+  Real Y_part[SPRAY_FUEL_NUM] = {1.};
+  const int lev = 0;
+  uniformSprayInit(
+    num_part, vel_part, dia_part, T_part, Y_part, lev, 1, num_ppp);
+  for (MyParIter pti(*this, lev); pti.isValid(); ++pti) {
+    const int Np = pti.numParticles();
+    const auto ptd = pti.GetParticleTile().getParticleTileData();
+    amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+      const SprayParticleRef p(ptd, pid);
+      const auto pidx = static_cast<std::uint64_t>(p.id());
+      for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+        p.rdata(SprayComps::pstateVel + dir) +=
+          vel_fluct * (2. * jetRandom(0, pidx, dir) - 1.);
+      }
+      p.rdata(SprayComps::pstateDia) *=
+        1. + dia_fluct * (2. * jetRandom(0, pidx, AMREX_SPACEDIM) - 1.);
+    });
+  }
+  Gpu::streamSynchronize();
+}
@@ -0,0 +1,441 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <AMReX_AmrCore.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Utility.H>
+
+#include "mechanism.H"
+#include <PelePhysics.H>
+#include "SprayParticles.H"
+
+// Spray parcel benchmark on a uniform gas phase state. The parcels are
+// updated and moved for nsteps steps and the cost per parcel is printed.
+// With particles.do_collision, the parcels also collide on every step and the
+// liquid mass and momentum are checked to be conserved by the collisions.
+// Optionally, the parcel data layout is compared with the former
+// array-of-structs layout on a representative update, and a checkpoint of the
+// parcels is restarted and compared with the original parcels
+
+// Single level mesh of the particle container, the gas phase state is owned
+// by main
+class SprayTestMesh : public amrex::AmrCore
+{
+protected:
+  void MakeNewLevelFromScratch(
+    int /*lev*/,
+    amrex::Real /*time*/,
+    const amrex::BoxArray& /*ba*/,
+    const amrex::DistributionMapping& /*dm*/) override
+  {
+  }
+
+  void MakeNewLevelFromCoarse(
+    int /*lev*/,
+    amrex::Real /*time*/,
+    const amrex::BoxArray& /*ba*/,
+    const amrex::DistributionMapping& /*dm*/) override
+  {
+  }
+
+  void RemakeLevel(
+    int /*lev*/,
+    amrex::Real /*time*/,
+    const amrex::BoxArray& /*ba*/,
+    const amrex::DistributionMapping& /*dm*/) override
+  {
+  }
+
+  void ClearLevel(int /*lev*/) override {}
+
+  void ErrorEst(
+    int /*lev*/,
+    amrex::TagBoxArray& /*tags*/,
+    amrex::Real /*time*/,
+    int /*ngrow*/) override
+  {
+  }
+};
+
+// Parcel of the former array-of-structs layout, all SprayComps components
+// are stored in the particle struct
+using AoSParcel = amrex::Particle<NAR_SPR, 0>;
+
+// Update reading and writing all parcel components, as done for each parcel
+// and subcycle in updateParticles: relax the velocity and temperature,
+// evaporate and move the parcel
+template <typename P>
+AMREX_GPU_DEVICE AMREX_FORCE_INLINE void
+fullUpdate(P& p, const amrex::Real dt)
+{
+  if (p.rdata(SprayComps::pstateFilmHght) > 0.) {
+    return;
+  }
+  const amrex::Real dia = p.rdata(SprayComps::pstateDia);
+  const amrex::Real relax = std::exp(-dt / (1.E3 * dia * dia + 1.E-12));
+  for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+    p.rdata(SprayComps::pstateVel + dir) *= relax;
+    p.pos(dir) += dt * p.rdata(SprayComps::pstateVel + dir);
+  }
+  p.rdata(SprayComps::pstateT) =
+    800. + (p.rdata(SprayComps::pstateT) - 800.) * relax;
+  amrex::Real sumY = 0.;
+  for (int spf = 0; spf < SPRAY_FUEL_NUM; ++spf) {
+    sumY += p.rdata(SprayComps::pstateY + spf);
+  }
+  p.rdata(SprayComps::pstateDia) = dia * (1. - 1.E-3 * (1. - relax) * sumY);
+  p.rdata(SprayComps::pstateNumDens) = p.rdata(SprayComps::pstateN0);
+  p.rdata(SprayComps::pstateBM1) += dt * relax;
+  p.rdata(SprayComps::pstateBM2) += dt;
+}
+
+// Time of nrep evaluations of f(i) for i < n on this rank
+template <typename F>
+amrex::Real
+timeParcels(const int n, const int nrep, F f)
+{
+  amrex::ParallelFor(n, f);
+  amrex::Gpu::streamSynchronize();
+  const amrex::Real strt_time = amrex::ParallelDescriptor::second();
+  for (int r = 0; r < nrep; ++r) {
+    amrex::ParallelFor(n, f);
+  }
+  amrex::Gpu::streamSynchronize();
+  return amrex::ParallelDescriptor::second() - strt_time;
+}
+
+// Sum over the parcels of the id, the position and each component
+amrex::Vector<amrex::Real>
+parcelSums(SprayParticleContainer& spc)
+{
+  const int nsums = 1 + AMREX_SPACEDIM + NAR_SPR;
+  amrex::Vector<amrex::Real> sums(nsums, 0.);
+  for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+    const int Np = pti.numParticles();
+    const auto ptd = pti.GetParticleTile().getParticleTileData();
+    for (int n = 0; n < nsums; ++n) {
+      sums[n] += amrex::Reduce::Sum<amrex::Real>(
+        Np,
+        [=] AMREX_GPU_DEVICE(int pid) noexcept -> amrex::Real {
+          const SprayParticleRef p(ptd, pid);
+          if (n == 0) {
+            return static_cast<amrex::Real>(p.id());
+          } else if (n <= AMREX_SPACEDIM) {
+            return p.pos(n - 1);
+          }
+          return p.rdata(n - 1 - AMREX_SPACEDIM);
+        },
+        0.);
+    }
+  }
+  amrex::ParallelDescriptor::ReduceRealSum(sums.data(), nsums);
+  return sums;
+}
+
+// Liquid mass and momentum of the parcels, followed by the sum of the
+// magnitude of each momentum component to scale the differences
+amrex::Vector<amrex::Real>
+liquidSums(SprayParticleContainer& spc)
+{
+  const int nsums = 1 + 2 * AMREX_SPACEDIM;
+  const SprayData fdat = *SprayParticleContainer::getSprayData();
+  amrex::Vector<amrex::Real> sums(nsums, 0.);
+  for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+    const int Np = pti.numParticles();
+    const auto ptd = pti.GetParticleTile().getParticleTileData();
+    for (int n = 0; n < nsums; ++n) {
+      sums[n] += amrex::Reduce::Sum<amrex::Real>(
+        Np,
+        [=] AMREX_GPU_DEVICE(int pid) noexcept -> amrex::Real {
+          const SprayParticleRef p(ptd, pid);
+          if (p.id() <= 0) {
+            return 0.;
+          }
+          amrex::Real cp_part = 0.;
+          const amrex::Real mass = p.rdata(SprayComps::pstateNumDens) *
+                                   parcelDropMass(p, fdat, cp_part);
+          if (n == 0) {
+            return mass;
+          } else if (n <= AMREX_SPACEDIM) {
+            return mass * p.rdata(SprayComps::pstateVel + n - 1);
+          }
+          return mass * std::abs(p.rdata(
+                          SprayComps::pstateVel + n - 1 - AMREX_SPACEDIM));
+        },
+        0.);
+    }
+  }
+  amrex::ParallelDescriptor::ReduceRealSum(sums.data(), nsums);
+  return sums;
+}
+
+int
+main(int argc, char* argv[])
+{
+  amrex::Initialize(argc, argv);
+  {
+    amrex::ParmParse pp;
+
+    int nsteps = 5;
+    pp.query("nsteps", nsteps);
+    // Flow time step (s) and parcel CFL number of the step, parcels are
+    // subcycled if it is larger than 0.5
+    amrex::Real dt = 1.E-6;
+    pp.query("dt", dt);
+    amrex::Real spray_cfl_lev = -1.;
+    pp.query("spray_cfl_lev", spray_cfl_lev);
+    // Uniform gas phase state (CGS units)
+    amrex::Real T_gas = 800.;
+    pp.query("gas_temp", T_gas);
+    amrex::Real p_gas = 1.01325E6;
+    pp.query("gas_pres", p_gas);
+    amrex::Vector<amrex::Real> vel_gas(AMREX_SPACEDIM, 0.);
+    pp.queryarr("gas_vel", vel_gas);
+    // Number of repetitions of the data layout comparison, 0 to skip it
+    int layout_nrep = 0;
+    pp.query("layout_nrep", layout_nrep);
+    bool check_restart = false;
+    pp.query("check_restart", check_restart);
+
+    pele::physics::PeleParams<
+      pele::physics::eos::EosParm<pele::physics::PhysicsType::eos_type>>
+      eos_parms;
+    eos_parms.initialize();
+    pele::physics::PeleParams<pele::physics::transport::TransParm<
+      pele::physics::PhysicsType::eos_type,
+      pele::physics::PhysicsType::transport_type>>
+      trans_parms;
+    trans_parms.initialize();
+    auto const* ltransparm = trans_parms.device_parm();
+
+    SprayTestMesh mesh;
+    mesh.InitFromScratch(0.);
+    const amrex::BoxArray& ba = mesh.boxArray(0);
+    const amrex::DistributionMapping& dm = mesh.DistributionMap(0);
+
+    // Gas phase state: density, momentum, total energy, temperature and
+    // partial densities, and spray sources of mass, momentum, energy and
+    // fuel partial densities
+    SprayComps scomps;
+    scomps.rhoIndx = 0;
+    scomps.momIndx = 1;
+    scomps.engIndx = AMREX_SPACEDIM + 1;
+    scomps.utempIndx = AMREX_SPACEDIM + 2;
+    scomps.specIndx = AMREX_SPACEDIM + 3;
+    scomps.rhoSrcIndx = 0;
+    scomps.momSrcIndx = 1;
+    scomps.engSrcIndx = AMREX_SPACEDIM + 1;
+    scomps.specSrcIndx = AMREX_SPACEDIM + 2;
+    const int nstate = AMREX_SPACEDIM + 3 + NUM_SPECIES;
+    const int nsource = AMREX_SPACEDIM + 2 + SPRAY_FUEL_NUM;
+
+    int particle_verbose = 0;
+    SprayParticleContainer::readSprayParams(particle_verbose);
+    SprayParticleContainer::AssignSprayComps(scomps);
+    const amrex::Real body_force[AMREX_SPACEDIM] = {AMREX_D_DECL(0., 0., 0.)};
+    SprayParticleContainer::spraySetup(body_force);
+
+    const int state_ghosts = SprayParticleContainer::getStateGhostCells(
+      0, 0, 1, SprayParticleContainer::spray_cfl);
+    const int source_ghosts = SprayParticleContainer::getSourceGhostCells(
+      0, 0, 1, SprayParticleContainer::spray_cfl);
+    amrex::MultiFab state(ba, dm, nstate, state_ghosts);
+    amrex::MultiFab source(ba, dm, nsource, source_ghosts);
+    {
+      amrex::Real Y[NUM_SPECIES] = {0.};
+      Y[O2_ID] = 0.233;
+      Y[N2_ID] = 0.767;
+      amrex::Real rho = 0.;
+      amrex::Real eint = 0.;
+      auto eos = pele::physics::PhysicsType::eos();
+      eos.PYT2RE(p_gas, Y, T_gas, rho, eint);
+      amrex::Real ke = 0.;
+      for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+        state.setVal(rho * vel_gas[dir], scomps.momIndx + dir, 1, state_ghosts);
+        ke += 0.5 * vel_gas[dir] * vel_gas[dir];
+      }
+      state.setVal(rho, scomps.rhoIndx, 1, state_ghosts);
+      state.setVal(rho * (eint + ke), scomps.engIndx, 1, state_ghosts);
+      state.setVal(T_gas, scomps.utempIndx, 1, state_ghosts);
+      for (int n = 0; n < NUM_SPECIES; ++n) {
+        state.setVal(rho * Y[n], scomps.specIndx + n, 1, state_ghosts);
+      }
+    }
+
+    amrex::BCRec phys_bc;
+    for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+      phys_bc.setLo(dir, amrex::PhysBCType::interior);
+      phys_bc.setHi(dir, amrex::PhysBCType::interior);
+    }
+    SprayParticleContainer spc(&mesh, &phys_bc);
+    spc.SetVerbose(particle_verbose);
+    spc.SprayInitialize();
+    spc.Redistribute();
+    const amrex::Long num_parts = spc.TotalNumberOfParticles();
+    amrex::Print() << num_parts << " parcels on " << ba.size()
+                   << " boxes of " << ba.numPts() << " cells, "
+                   << amrex::ParallelDescriptor::NProcs() << " ranks"
+                   << std::endl;
+
+    amrex::Real update_time = 0.;
+    amrex::Real redist_time = 0.;
+    amrex::Real coll_time = 0.;
+    amrex::Real coll_diff = 0.;
+    const bool do_collision = SprayParticleContainer::m_doCollision;
+    amrex::Real time = 0.;
+    for (int step = 0; step < nsteps; ++step) {
+      source.setVal(0.);
+      amrex::ParallelDescriptor::Barrier();
+      amrex::Real strt_time = amrex::ParallelDescriptor::second();
+      spc.updateParticles(
+        0, state, source, dt, time, state_ghosts, source_ghosts, false, false,
+        true, ltransparm, spray_cfl_lev);
+      amrex::Gpu::streamSynchronize();
+      update_time += amrex::ParallelDescriptor::second() - strt_time;
+      strt_time = amrex::ParallelDescriptor::second();
+      spc.Redistribute();
+      redist_time += amrex::ParallelDescriptor::second() - strt_time;
+      if (do_collision) {
+        const auto sums = liquidSums(spc);
+        amrex::ParallelDescriptor::Barrier();
+        strt_time = amrex::ParallelDescriptor::second();
+        spc.collideParcels(0, dt, step);
+        amrex::Gpu::streamSynchronize();
+        coll_time += amrex::ParallelDescriptor::second() - strt_time;
+        const auto sums_coll = liquidSums(spc);
+        for (int n = 0; n <= AMREX_SPACEDIM; ++n) {
+          const amrex::Real diff = std::abs(sums_coll[n] - sums[n]);
+          const amrex::Real scale =
+            (n == 0) ? sums[0] : sums[n + AMREX_SPACEDIM];
+          coll_diff = amrex::max(coll_diff, (scale > 0.) ? diff / scale : diff);
+        }
+      }
+      time += dt;
+    }
+    amrex::ParallelDescriptor::ReduceRealMax(update_time);
+    amrex::ParallelDescriptor::ReduceRealMax(redist_time);
+    amrex::ParallelDescriptor::ReduceRealMax(coll_time);
+    const amrex::Real parcel_steps =
+      static_cast<amrex::Real>(num_parts) * amrex::max(nsteps, 1);
+    amrex::Print() << " >> updateParticles: " << update_time / parcel_steps
+                   << " s per parcel and step\n"
+                   << " >> Redistribute: " << redist_time / parcel_steps
+                   << " s per parcel and step" << std::endl;
+    if (do_collision) {
+      amrex::Print() << " >> collideParcels: " << coll_time / parcel_steps
+                     << " s per parcel and step, max relative change of the "
+                        "liquid mass and momentum "
+                     << coll_diff << std::endl;
+      if (coll_diff > 1.E-10) {
+        amrex::Abort("Collisions do not conserve liquid mass and momentum");
+      }
+    }
+
+    if (layout_nrep > 0) {
+      // Copy the parcels to the former array-of-structs layout and time the
+      // same updates on both. The full update touches every component, the
+      // velocity reduction only the three velocity components, like the
+      // time step estimate
+      amrex::Real soa_full = 0.;
+      amrex::Real aos_full = 0.;
+      amrex::Real soa_vel = 0.;
+      amrex::Real aos_vel = 0.;
+      amrex::Gpu::DeviceVector<amrex::Real> vmax_v(1);
+      amrex::Real* vmax = vmax_v.data();
+      for (MyParIter pti(spc, 0); pti.isValid(); ++pti) {
+        const int Np = pti.numParticles();
+        const auto ptd = pti.GetParticleTile().getParticleTileData();
+        amrex::Gpu::DeviceVector<AoSParcel> aos_v(Np);
+        AoSParcel* aos = aos_v.data();
+        amrex::ParallelFor(Np, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+          const SprayParticleRef p(ptd, pid);
+          for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+            aos[pid].pos(dir) = p.pos(dir);
+          }
+          for (int comp = 0; comp < NAR_SPR; ++comp) {
+            aos[pid].rdata(comp) = p.rdata(comp);
+          }
+        });
+        soa_full += timeParcels(
+          Np, layout_nrep, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+            SprayParticleRef p(ptd, pid);
+            fullUpdate(p, 1.E-9);
+          });
+        aos_full += timeParcels(
+          Np, layout_nrep, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+            fullUpdate(aos[pid], 1.E-9);
+          });
+        soa_vel += timeParcels(
+          Np, layout_nrep, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+            const SprayParticleRef p(ptd, pid);
+            amrex::Real v = 0.;
+            for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+              v = amrex::max(v, std::abs(p.rdata(SprayComps::pstateVel + dir)));
+            }
+            amrex::Gpu::Atomic::Max(vmax, v);
+          });
+        aos_vel += timeParcels(
+          Np, layout_nrep, [=] AMREX_GPU_DEVICE(int pid) noexcept {
+            amrex::Real v = 0.;
+            for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+              v = amrex::max(
+                v, std::abs(aos[pid].rdata(SprayComps::pstateVel + dir)));
+            }
+            amrex::Gpu::Atomic::Max(vmax, v);
+          });
+      }
+      amrex::Real layout_times[4] = {soa_full, aos_full, soa_vel, aos_vel};
+      amrex::ParallelDescriptor::ReduceRealMax(layout_times, 4);
+      for (auto& t : layout_times) {
+        t /= static_cast<amrex::Real>(layout_nrep) * num_parts;
+      }
+      soa_full = layout_times[0];
+      aos_full = layout_times[1];
+      soa_vel = layout_times[2];
+      aos_vel = layout_times[3];
+      amrex::Print() << " >> parcel layouts, s per parcel: full update SoA "
+                     << soa_full << ", AoS " << aos_full
+                     << "; velocity reduction SoA " << soa_vel << ", AoS "
+                     << aos_vel << std::endl;
+    }
+
+    if (check_restart) {
+      // Write a checkpoint of the parcels, restart a second container from
+      // it and compare the parcel data
+      const std::string chk_dir = "chk_spray";
+      if (amrex::ParallelDescriptor::IOProcessor()) {
+        amrex::UtilCreateCleanDirectory(chk_dir, false);
+      }
+      amrex::ParallelDescriptor::Barrier();
+      spc.SprayParticleIO(0, true, chk_dir);
+      SprayParticleContainer spc_rst(&mesh, &phys_bc);
+      spc_rst.Restart(chk_dir, "particles");
+      const auto sums = parcelSums(spc);
+      const auto sums_rst = parcelSums(spc_rst);
+      amrex::Real max_diff = 0.;
+      for (int n = 0; n < static_cast<int>(sums.size()); ++n) {
+        const amrex::Real diff = std::abs(sums_rst[n] - sums[n]);
+        max_diff = amrex::max(
+          max_diff, (sums[n] != 0.) ? diff / std::abs(sums[n]) : diff);
+      }
+      amrex::Print() << " >> restart: " << spc_rst.TotalNumberOfParticles()
+                     << " parcels, max relative difference of the parcel "
+                        "data "
+                     << max_diff << std::endl;
+      if (
+        spc_rst.TotalNumberOfParticles() != spc.TotalNumberOfParticles() ||
+        max_diff > 1.E-12) {
+        amrex::Abort("Restarted parcels do not match the checkpoint");
+      }
+    }
+
+    SprayParticleContainer::SprayCleanUp();
+    trans_parms.deallocate();
+    eos_parms.deallocate();
+  }
+  amrex::Finalize();
+
+  return 0;
+}
@@ -5,6 +5,7 @@
 #include <AMReX_VisMF.H>
 #include <AMReX_ParmParse.H>
 #include <AMReX_PlotFileUtil.H>
+#include <AMReX_ParReduce.H>
 
 #include "mechanism.H"
 #include <GPU_misc.H>
@@ -99,29 +100,169 @@ main(int argc, char* argv[])
     // Get the transport data pointer
     auto const* ltransparm = trans_parms.device_parm();
 
+    // Number of repeated evaluations used to time the transport kernels
+    int niter = 1;
+    pp.query("niter", niter);
+
+    amrex::Real strt_time = amrex::ParallelDescriptor::second();
+    for (int iter = 0; iter < niter; ++iter) {
+      BL_PROFILE("Pele::get_transport_coeffs()");
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+      for (amrex::MFIter mfi(mass_frac, amrex::TilingIfNotGPU()); mfi.isValid();
+           ++mfi) {
+
+        const amrex::Box& gbox = mfi.tilebox();
+
+        amrex::Array4<amrex::Real> const& Y_a = mass_frac.array(mfi);
+        amrex::Array4<amrex::Real> const& T_a = temperature.array(mfi);
+        amrex::Array4<amrex::Real> const& rho_a = density.array(mfi);
+        amrex::Array4<amrex::Real> const& D_a = D.array(mfi);
+        amrex::Array4<amrex::Real> const& mu_a = mu.array(mfi);
+        amrex::Array4<amrex::Real> const& xi_a = xi.array(mfi);
+        amrex::Array4<amrex::Real> const& lam_a = lam.array(mfi);
+        amrex::Array4<amrex::Real> const& chi_a = chi.array(mfi);
+
+        amrex::launch(gbox, [=] AMREX_GPU_DEVICE(amrex::Box const& tbx) {
+          auto trans = pele::physics::PhysicsType::transport();
+          trans.get_transport_coeffs(
+            tbx, Y_a, T_a, rho_a, D_a, chi_a, mu_a, xi_a, lam_a, ltransparm);
+        });
+      }
+      amrex::Gpu::streamSynchronize();
+    }
+    amrex::Real mix_time = amrex::ParallelDescriptor::second() - strt_time;
+    amrex::ParallelDescriptor::ReduceRealMax(
+      mix_time, amrex::ParallelDescriptor::IOProcessorNumber());
+    const auto ncells = static_cast<amrex::Real>(domain.numPts());
+    amrex::Print() << " >> get_transport_coeffs: " << mix_time << " s, "
+                   << ncells * niter / mix_time << " cells/s\n";
+
+#ifdef USE_MULTICOMPONENT_TRANSPORT
+    amrex::MultiFab Dmat(ba, dm, NUM_SPECIES * NUM_SPECIES, num_grow);
+    amrex::MultiFab theta(ba, dm, NUM_SPECIES, num_grow);
+    strt_time = amrex::ParallelDescriptor::second();
+    for (int iter = 0; iter < niter; ++iter) {
+      BL_PROFILE("Pele::get_multicomponent_coeffs()");
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
+      for (amrex::MFIter mfi(mass_frac, amrex::TilingIfNotGPU()); mfi.isValid();
+           ++mfi) {
+
+        const amrex::Box& gbox = mfi.tilebox();
+
+        auto const& Y_a = mass_frac.const_array(mfi);
+        auto const& T_a = temperature.const_array(mfi);
+        auto const& Dmat_a = Dmat.array(mfi);
+        auto const& theta_a = theta.array(mfi);
+
+        amrex::launch(gbox, [=] AMREX_GPU_DEVICE(amrex::Box const& tbx) {
+          auto trans = pele::physics::PhysicsType::transport();
+          trans.get_multicomponent_coeffs(
+            tbx, Y_a, T_a, Dmat_a, theta_a, ltransparm);
+        });
+      }
+      amrex::Gpu::streamSynchronize();
+    }
+    amrex::Real mc_time = amrex::ParallelDescriptor::second() - strt_time;
+    amrex::ParallelDescriptor::ReduceRealMax(
+      mc_time, amrex::ParallelDescriptor::IOProcessorNumber());
+    amrex::Print() << " >> get_multicomponent_coeffs ("
+                   << trans_parms.host_parm().num_iter
+                   << " iterations): " << mc_time << " s, "
+                   << ncells * niter / mc_time
+                   << " cells/s, cost relative to mixture-averaged: "
+                   << mc_time / mix_time << "\n";
+
+    // Check against the converged result of the EGlib iterations, obtained
+    // from a direct solve: the configured iterations must be within mc_tol
+    // and mc_conv_iterations of them must recover the direct solve
+    amrex::Real mc_tol = 0.1;
+    pp.query("mc_tol", mc_tol);
+    int mc_conv_iter = 50;
+    pp.query("mc_conv_iterations", mc_conv_iter);
+
+    amrex::MultiFab Dref(ba, dm, NUM_SPECIES * NUM_SPECIES, num_grow);
+    strt_time = amrex::ParallelDescriptor::second();
     for (amrex::MFIter mfi(mass_frac, amrex::TilingIfNotGPU()); mfi.isValid();
          ++mfi) {
-
       const amrex::Box& gbox = mfi.tilebox();
+      auto const& Y_a = mass_frac.const_array(mfi);
+      auto const& T_a = temperature.const_array(mfi);
+      auto const& Dref_a = Dref.array(mfi);
+      amrex::ParallelFor(
+        gbox, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+          amrex::Real massloc[NUM_SPECIES] = {0.0};
+          for (int n = 0; n < NUM_SPECIES; ++n) {
+            massloc[n] = Y_a(i, j, k, n);
+          }
+          amrex::Real Dloc[NUM_SPECIES * NUM_SPECIES] = {0.0};
+          multicomponent_reference(T_a(i, j, k), massloc, Dloc, ltransparm);
+          for (int n = 0; n < NUM_SPECIES * NUM_SPECIES; ++n) {
+            Dref_a(i, j, k, n) = Dloc[n];
+          }
+        });
+    }
+    amrex::Gpu::streamSynchronize();
+    amrex::Real ref_time = amrex::ParallelDescriptor::second() - strt_time;
+    amrex::ParallelDescriptor::ReduceRealMax(
+      ref_time, amrex::ParallelDescriptor::IOProcessorNumber());
 
-      amrex::Array4<amrex::Real> const& Y_a = mass_frac.array(mfi);
-      amrex::Array4<amrex::Real> const& T_a = temperature.array(mfi);
-      amrex::Array4<amrex::Real> const& rho_a = density.array(mfi);
-      amrex::Array4<amrex::Real> const& D_a = D.array(mfi);
-      amrex::Array4<amrex::Real> const& mu_a = mu.array(mfi);
-      amrex::Array4<amrex::Real> const& xi_a = xi.array(mfi);
-      amrex::Array4<amrex::Real> const& lam_a = lam.array(mfi);
-      amrex::Array4<amrex::Real> const& chi_a = chi.array(mfi);
+    // Max over the cells of max_ij |Dmat_ij - Dref_ij| / max_ij |Dref_ij|
+    auto mc_error = [&](amrex::MultiFab const& Dm) {
+      auto const& Dm_a = Dm.const_arrays();
+      auto const& Dref_a = Dref.const_arrays();
+      amrex::Real err = amrex::ParReduce(
+        amrex::TypeList<amrex::ReduceOpMax>{}, amrex::TypeList<amrex::Real>{},
+        Dm, amrex::IntVect(0),
+        [=] AMREX_GPU_DEVICE(int box_no, int i, int j, int k) noexcept
+        -> amrex::GpuTuple<amrex::Real> {
+          amrex::Real diff = 0.0;
+          amrex::Real dmax = 0.0;
+          for (int n = 0; n < NUM_SPECIES * NUM_SPECIES; ++n) {
+            const amrex::Real r = Dref_a[box_no](i, j, k, n);
+            diff = amrex::max(diff, std::abs(Dm_a[box_no](i, j, k, n) - r));
+            dmax = amrex::max(dmax, std::abs(r));
+          }
+          return {diff / dmax};
+        });
+      amrex::ParallelDescriptor::ReduceRealMax(err);
+      return err;
+    };
+    const amrex::Real mc_err = mc_error(Dmat);
 
+    const int num_iter = trans_parms.host_parm().num_iter;
+    trans_parms.host_parm().num_iter = mc_conv_iter;
+    trans_parms.sync_to_device();
+    for (amrex::MFIter mfi(mass_frac, amrex::TilingIfNotGPU()); mfi.isValid();
+         ++mfi) {
+      const amrex::Box& gbox = mfi.tilebox();
+      auto const& Y_a = mass_frac.const_array(mfi);
+      auto const& T_a = temperature.const_array(mfi);
+      auto const& Dmat_a = Dmat.array(mfi);
+      auto const& theta_a = theta.array(mfi);
       amrex::launch(gbox, [=] AMREX_GPU_DEVICE(amrex::Box const& tbx) {
         auto trans = pele::physics::PhysicsType::transport();
-        trans.get_transport_coeffs(
-          tbx, Y_a, T_a, rho_a, D_a, chi_a, mu_a, xi_a, lam_a, ltransparm);
+        trans.get_multicomponent_coeffs(
+          tbx, Y_a, T_a, Dmat_a, theta_a, ltransparm);
       });
     }
+    amrex::Gpu::streamSynchronize();
+    const amrex::Real conv_err = mc_error(Dmat);
+    trans_parms.host_parm().num_iter = num_iter;
+    trans_parms.sync_to_device();
+
+    amrex::Print() << " >> direct solve: " << ref_time << " s for one pass\n"
+                   << " >> relative error vs direct solve: " << mc_err
+                   << " with " << num_iter << " iterations (tolerance "
+                   << mc_tol << "), " << conv_err << " with " << mc_conv_iter
+                   << " iterations\n";
+    if (!(mc_err < mc_tol) || !(conv_err < 1.0e-8)) {
+      amrex::Abort("Multicomponent diffusion does not match the direct solve");
+    }
+#endif
 
     trans_parms.deallocate();
     eos_parms.deallocate();